@@ -0,0 +1,96 @@
+#ifndef AVL_HPP
+#define AVL_HPP
+#include "BST.hpp"
+using namespace std;
+
+/** BST that keeps itself balanced as an AVL tree: the heights of the two
+ *  subtrees of every node differ by at most one, so the height stays below
+ *  1.44 log2(n + 2) for any insertion order, sorted input included. Nodes
+ *  keep valid parent links through rotations, so iterators work unchanged,
+ *  and rotations recount the two nodes they move when Counted is set.
+ */
+template <typename Data, typename Compare = ThreeWayCompare<Data>,
+          bool Counted = false>
+class AVL : public BST<Data, Compare, Counted> {
+  public:
+    /** Default constructor.
+     *  Initialize an empty AVL tree.
+     *  @param compare Three-way comparator that orders the items
+     */
+    AVL(const Compare& compare = Compare())
+        : BST<Data, Compare, Counted>(compare) {}
+
+  protected:
+    typedef BST<Data, Compare, Counted> Base;
+
+    /** Restores the heights of a node and its ancestors, rotating every node
+     *  whose subtrees differ in height by two back into balance. Stops at the
+     *  first node whose height stays the same.
+     *  @param node Lowest node whose children changed
+     */
+    void fixUp(BSTNode<Data>* node) override {
+        while (node != nullptr) {
+            int oldHeight = node->height;
+            Base::updateHeight(node);
+            int balance = balanceOf(node);
+            if (balance > 1) {
+                if (balanceOf(node->left) < 0) {  // left-right case
+                    rotateLeft(node->left);
+                }
+                node = rotateRight(node);
+            } else if (balance < -1) {
+                if (balanceOf(node->right) > 0) {  // right-left case
+                    rotateRight(node->right);
+                }
+                node = rotateLeft(node);
+            }
+            if (node->height == oldHeight) {
+                return;
+            }
+            node = node->parent;
+        }
+    }
+
+  private:
+    /** Returns how much taller the left subtree of a node is than its right
+     */
+    static int balanceOf(BSTNode<Data>* n) {
+        return Base::heightOf(n->left) - Base::heightOf(n->right);
+    }
+
+    /** Rotates the right child of a node up into its place.
+     *  @return The node now at the top of the rotated subtree
+     */
+    BSTNode<Data>* rotateLeft(BSTNode<Data>* node) {
+        BSTNode<Data>* child = node->right;
+        node->right = child->left;
+        if (child->left != nullptr) {
+            child->left->parent = node;
+        }
+        Base::replaceChild(node, child);
+        child->left = node;
+        node->parent = child;
+        Base::updateHeight(node);
+        Base::updateHeight(child);
+        return child;
+    }
+
+    /** Rotates the left child of a node up into its place.
+     *  @return The node now at the top of the rotated subtree
+     */
+    BSTNode<Data>* rotateRight(BSTNode<Data>* node) {
+        BSTNode<Data>* child = node->left;
+        node->left = child->right;
+        if (child->right != nullptr) {
+            child->right->parent = node;
+        }
+        Base::replaceChild(node, child);
+        child->right = node;
+        node->parent = child;
+        Base::updateHeight(node);
+        Base::updateHeight(child);
+        return child;
+    }
+};
+
+#endif  // AVL_HPP
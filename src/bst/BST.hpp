@@ -1,12 +1,26 @@
 #ifndef BST_HPP
 #define BST_HPP
+#include <algorithm>
+#include <future>
 #include <iostream>
+#include <numeric>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include "BSTIterator.hpp"
 #include "BSTNode.hpp"
+#include "NodePool.hpp"
+#include "ThreeWayCompare.hpp"
 using namespace std;
 
-template <typename Data>
+/** Binary search tree of distinct items ordered by a three-way Compare.
+ *  When Counted is set, every node also keeps the number of nodes in its
+ *  subtree, which insert and erase update along the path to the root, and
+ *  select and rank answer order statistics in O(height).
+ */
+template <typename Data, typename Compare = ThreeWayCompare<Data>,
+          bool Counted = false>
 class BST {
   protected:
     // pointer to the root of this BST, or 0 if the BST is empty
@@ -18,17 +32,29 @@ class BST {
     // height of this BST.
     int iheight;
 
+    // storage that every node of this BST is allocated from
+    NodePool<BSTNode<Data>> pool;
+
+    // three-way comparator that orders the Data items
+    Compare compare;
+
   public:
     /** Define iterator as an aliased typename for BSTIterator<Data>. */
     typedef BSTIterator<Data> iterator;
 
     /** Default constructor.
      *  Initialize an empty BST.
+     *  @param compare Three-way comparator that orders the items
      */
-    BST() : root(0), isize(0), iheight(-1) {}
+    BST(const Compare& compare = Compare())
+        : root(0), isize(0), iheight(-1), compare(compare) {}
+
+    /** A BST owns its nodes, so it cannot be copied */
+    BST(const BST&) = delete;
+    BST& operator=(const BST&) = delete;
 
     /** Deconstructor.
-     *  Deletes the pointer to the root after deleting the rest of the nodes.
+     *  Destroys every node, then the pool releases their storage in bulk.
      */
     virtual ~BST() { deleteAll(root); }
 
@@ -38,50 +64,111 @@ class BST {
      *  @return True if successfully inserted. False if duplicate insertion
      *          or otherwise.
      */
-    virtual bool insert(const Data& item) {
-        // create new node with item
-        BSTNode<Data>* node = new BSTNode<Data>(item);
-        int height = 0;  // keep track of height as we go down BST
+    virtual bool insert(const Data& item) { return insertItem(item); }
 
-        // no root, then new node is root
-        if (root == nullptr) {
-            root = node;
-            ++isize;
-            iheight = height;
-            return true;
+    /** Inserts an item, moving it into the new node instead of copying.
+     *  @param item Data to move into a BSTNode that will go in the tree
+     *  @return True if successfully inserted. False if duplicate insertion,
+     *          in which case item is left unchanged.
+     */
+    virtual bool insert(Data&& item) { return insertItem(std::move(item)); }
+
+    /** Inserts an item constructed from the given arguments, moving it into
+     *  the new node.
+     *  @return True if successfully inserted. False if duplicate insertion.
+     */
+    template <typename... Args>
+    bool emplace(Args&&... args) {
+        return insert(Data(std::forward<Args>(args)...));
+    }
+
+    /** Removes an item from the BST. The nodes of other items are relinked
+     *  rather than copied, so iterators to them stay valid.
+     *  @param item Data to remove
+     *  @return True if the item was removed. False if it was not in the BST.
+     */
+    bool erase(const Data& item) {
+        iterator position = find(item);
+        if (position == end()) {
+            return false;
         }
+        erase(position);
+        return true;
+    }
 
-        BSTNode<Data>* curr = root;     // start with root node
-        BSTNode<Data>* prev = nullptr;  // holds previous node so we can assign
+    /** Removes the item an iterator points to. Only iterators to that item
+     *  are invalidated.
+     *  @param position Iterator to an item of this BST, not end()
+     *  @return Iterator to the item after the removed one
+     */
+    iterator erase(iterator position) {
+        BSTNode<Data>* node = position.curr;
+        BSTNode<Data>* next = node->successor();
 
-        while (curr != nullptr) {  // loop till we find a spot for new node
-            prev = curr;
-            ++height;
-            if (item < curr->data) {  // go left
-                curr = curr->left;
-            } else if (curr->data < item) {  // go right
-                curr = curr->right;
-            } else {            // duplicate insertion
-                delete (node);  // delete heap item before returning
-                return false;
+        // lowest node whose subtree loses a level
+        BSTNode<Data>* changed;
+        if (node->left == nullptr || node->right == nullptr) {
+            changed = node->parent;
+            replaceChild(node,
+                         node->left != nullptr ? node->left : node->right);
+        } else {
+            // the successor is the leftmost node of the right subtree; it
+            // takes the place of node, and its right child takes its place
+            if (next->parent == node) {
+                changed = next;
+            } else {
+                changed = next->parent;
+                replaceChild(next, next->right);
+                next->right = node->right;
+                next->right->parent = next;
             }
+            replaceChild(node, next);
+            next->left = node->left;
+            next->left->parent = next;
+            next->height = node->height;
+            next->count = node->count;
         }
-        // found spot for new node
-        if (item < prev->data) {
-            prev->left = node;
-            node->parent = prev;
-        } else if (prev->data < item) {
-            prev->right = node;
-            node->parent = prev;
-        }
+        pool.destroy(node);
+        --isize;
+
+        addToCounts(changed, -1);
+        fixUp(changed);
+        iheight = heightOf(root);
+        return iterator(next);
+    }
 
-        // increase height if we added a new level
-        if (iheight < height) {
-            iheight = height;
+    /** Replaces the contents of this BST with the items in [first, last),
+     *  linked into a perfectly balanced tree in O(n) once they are sorted.
+     *  Input that is not sorted already is sorted first, on several threads
+     *  when it is large. Duplicates are kept once, as with insert.
+     *  @param first Iterator to the first item to put in the tree
+     *  @param last Iterator past the last item to put in the tree
+     */
+    template <typename Iter>
+    void buildFrom(Iter first, Iter last) {
+        deleteAll(root);
+        pool.clear();
+        root = nullptr;
+
+        vector<Data> items(first, last);
+        auto less = [this](const Data& a, const Data& b) {
+            return compare(a, b) < 0;
+        };
+        if (!is_sorted(items.begin(), items.end(), less)) {
+            parallelSort(items.begin(), items.end(), less,
+                         items.size() < PARALLEL_SORT_MIN
+                             ? 0
+                             : forkDepthFor(thread::hardware_concurrency()));
         }
-        ++isize;  // added a node, so increment size
+        items.erase(unique(items.begin(), items.end(),
+                           [this](const Data& a, const Data& b) {
+                               return compare(a, b) == 0;
+                           }),
+                    items.end());
 
-        return true;
+        root = linkBalanced(items, 0, items.size(), nullptr);
+        isize = items.size();
+        iheight = heightOf(root);
     }
 
     /** Find a Data item in the BST. Return iterator pointing to that item or
@@ -92,10 +179,11 @@ class BST {
     virtual iterator find(const Data& item) const {
         BSTNode<Data>* curr = root;  // used to traverse BST
 
-        while (curr != nullptr) {     // loop till we reach end or find item
-            if (item < curr->data) {  // go left
+        while (curr != nullptr) {  // loop till we reach end or find item
+            int order = compare(item, curr->data);
+            if (order < 0) {  // go left
                 curr = curr->left;
-            } else if (curr->data < item) {  // go right
+            } else if (order > 0) {  // go right
                 curr = curr->right;
             } else {  // found item
                 break;
@@ -105,6 +193,133 @@ class BST {
         return iterator(curr);
     }
 
+    /** Finds the first item that is not before the given one. Iterating
+     *  from there to upper_bound(high) visits the items in [item, high]
+     *  in O(log n + k) for k items, without walking the items before.
+     *  @param item Data to compare the items with
+     *  @return iterator to the smallest item not before item, or end()
+     */
+    iterator lower_bound(const Data& item) const {
+        return iterator(bound(item, true));
+    }
+
+    /** Finds the first item that is after the given one.
+     *  @param item Data to compare the items with
+     *  @return iterator to the smallest item after item, or end()
+     */
+    iterator upper_bound(const Data& item) const {
+        return iterator(bound(item, false));
+    }
+
+    /** Finds the range of items equal to the given one, which holds one
+     *  item at most since a BST keeps no duplicates.
+     *  @param item Data to compare the items with
+     *  @return lower_bound(item) and upper_bound(item)
+     */
+    pair<iterator, iterator> equal_range(const Data& item) const {
+        BSTNode<Data>* lower = bound(item, true);
+        if (lower != nullptr && compare(item, lower->data) == 0) {
+            return make_pair(iterator(lower), iterator(lower->successor()));
+        }
+        return make_pair(iterator(lower), iterator(lower));
+    }
+
+    /** Finds the item at a position in sorted order, skipping whole
+     *  subtrees by their counts. Only available when Counted is set.
+     *  @param k Number of items before the wanted one, from 0
+     *  @return iterator to the k-th smallest item, or end() if k >= size()
+     */
+    iterator select(unsigned int k) const {
+        static_assert(Counted, "select needs a BST with Counted set");
+        BSTNode<Data>* curr = root;
+        while (curr != nullptr) {
+            unsigned int leftCount = countOf(curr->left);
+            if (k < leftCount) {
+                curr = curr->left;
+            } else if (k > leftCount) {
+                k -= leftCount + 1;
+                curr = curr->right;
+            } else {
+                break;
+            }
+        }
+        return iterator(curr);
+    }
+
+    /** Counts the items that come before the given one, which need not be
+     *  in the BST. Only available when Counted is set.
+     *  @param item Data to compare the items with
+     *  @return Number of items before item, so select(rank(item)) is
+     *          lower_bound(item)
+     */
+    unsigned int rank(const Data& item) const {
+        static_assert(Counted, "rank needs a BST with Counted set");
+        unsigned int before = 0;
+        BSTNode<Data>* curr = root;
+        while (curr != nullptr) {
+            int order = compare(item, curr->data);
+            if (order > 0) {  // curr and its left subtree come before item
+                before += countOf(curr->left) + 1;
+                curr = curr->right;
+            } else if (order < 0) {
+                curr = curr->left;
+            } else {
+                before += countOf(curr->left);
+                break;
+            }
+        }
+        return before;
+    }
+
+    /** Looks up a batch of items in one ordered pass. The queries are
+     *  visited in sorted order, and each search starts from a finger: the
+     *  largest node reached by the previous search that is not after the
+     *  query. The search climbs from the finger only as far as the query
+     *  can be, then descends, so in a balanced tree it costs O(log d) for a
+     *  query d items past the previous one. For batches about as large as
+     *  the tree this is close to one in-order walk instead of a descent per
+     *  query.
+     *  @param queries Items to look for, in any order
+     *  @return Whether each query is in the BST, in the order of queries
+     */
+    vector<bool> contains(const vector<Data>& queries) const {
+        vector<size_t> order(queries.size());
+        iota(order.begin(), order.end(), 0);
+        sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return compare(queries[a], queries[b]) < 0;
+        });
+
+        vector<bool> found(queries.size(), false);
+        BSTNode<Data>* finger = nullptr;  // largest node not after query
+        for (size_t index : order) {
+            const Data& query = queries[index];
+            BSTNode<Data>* curr = root;
+            if (finger != nullptr) {
+                // climb past ancestors not after the query; the first one
+                // after it bounds a subtree that holds the query if any
+                curr = finger;
+                while (curr->parent != nullptr &&
+                       compare(query, curr->parent->data) >= 0) {
+                    curr = curr->parent;
+                }
+            }
+            while (curr != nullptr) {
+                int side = compare(query, curr->data);
+                if (side < 0) {
+                    curr = curr->left;
+                } else {
+                    finger = curr;
+                    if (side == 0) {
+                        found[index] = true;
+                        break;
+                    }
+                    curr = curr->right;
+                }
+            }
+        }
+        return found;
+    }
+
     /** Returns the number of items currently in BST.
      *  @return Number of items in BST.
      */
@@ -128,7 +343,7 @@ class BST {
     /** Return an iterator pointing past the last item in the BST.
      *  @return Iterator pointing to end of BST, past last time.
      */
-    iterator end() const { return typename BST<Data>::iterator(0); }
+    iterator end() const { return iterator(0); }
 
     /** Perform in order traversal through BST and return the order as vector.
      *  @return Vector that contains data of BST in order from smallest to
@@ -136,6 +351,7 @@ class BST {
      */
     vector<Data> inorder() const {
         vector<Data> order{};
+        order.reserve(isize);
         iterator iter = begin();  // start from smallest element and iterate
         iterator endBST = end();
         while (iter != endBST) {  // stop when we reach end of BST
@@ -145,7 +361,189 @@ class BST {
         return order;
     }
 
+  protected:
+    /** Finds the slot for an item and only then allocates its node, so a
+     *  duplicate insertion allocates and copies nothing.
+     *  @param item Data to copy or move into the new node
+     *  @return True if inserted. False if duplicate insertion.
+     */
+    template <typename Item>
+    bool insertItem(Item&& item) {
+        BSTNode<Data>* curr = root;     // start with root node
+        BSTNode<Data>* prev = nullptr;  // holds previous node so we can assign
+        int order = 0;                  // item compared to prev's data
+
+        while (curr != nullptr) {  // loop till we find a spot for new node
+            prev = curr;
+            order = compare(item, curr->data);
+            if (order < 0) {  // go left
+                curr = curr->left;
+            } else if (order > 0) {  // go right
+                curr = curr->right;
+            } else {  // duplicate insertion
+                return false;
+            }
+        }
+
+        // found spot for new node, or the tree is empty
+        BSTNode<Data>* node = pool.create(std::forward<Item>(item));
+        node->parent = prev;
+        if (prev == nullptr) {
+            root = node;
+        } else if (order < 0) {
+            prev->left = node;
+        } else {
+            prev->right = node;
+        }
+
+        // update the counts and heights above the new leaf
+        addToCounts(prev, 1);
+        fixUp(prev);
+        iheight = root->height;
+        ++isize;  // added a node, so increment size
+
+        return true;
+    }
+
+    /** Returns the height of a subtree, -1 for an empty one */
+    static int heightOf(BSTNode<Data>* n) {
+        return n == nullptr ? -1 : n->height;
+    }
+
+    /** Returns the number of nodes in a subtree, 0 for an empty one */
+    static unsigned int countOf(BSTNode<Data>* n) {
+        return n == nullptr ? 0 : n->count;
+    }
+
+    /** Recomputes the height of a node from the heights of its children,
+     *  and its count from theirs when counting.
+     */
+    static void updateHeight(BSTNode<Data>* n) {
+        n->height = 1 + max(heightOf(n->left), heightOf(n->right));
+        if (Counted) {
+            n->count = 1 + countOf(n->left) + countOf(n->right);
+        }
+    }
+
+    /** Adds delta to the count of a node and of each of its ancestors, when
+     *  counting. Runs before fixUp, so rotations see correct counts.
+     *  @param node Lowest node whose subtree gained or lost a node
+     */
+    static void addToCounts(BSTNode<Data>* node, int delta) {
+        if (!Counted) {
+            return;
+        }
+        for (; node != nullptr; node = node->parent) {
+            node->count += delta;
+        }
+    }
+
+    /** Puts child, which may be nullptr, in the place of node under node's
+     *  parent, or makes it the root.
+     */
+    void replaceChild(BSTNode<Data>* node, BSTNode<Data>* child) {
+        if (child != nullptr) {
+            child->parent = node->parent;
+        }
+        if (node->parent == nullptr) {
+            root = child;
+        } else if (node->parent->left == node) {
+            node->parent->left = child;
+        } else {
+            node->parent->right = child;
+        }
+    }
+
+    /** Restores the heights of a node and its ancestors after the subtree
+     *  below the node changed shape. Stops at the first node whose height
+     *  stays the same, since no height above it can change either.
+     *  Subclasses override this to also rebalance along the way.
+     *  @param node Lowest node whose children changed
+     */
+    virtual void fixUp(BSTNode<Data>* node) {
+        while (node != nullptr) {
+            int oldHeight = node->height;
+            updateHeight(node);
+            if (node->height == oldHeight) {
+                return;
+            }
+            node = node->parent;
+        }
+    }
+
   private:
+    // inputs to buildFrom with fewer items than this are sorted serially
+    enum { PARALLEL_SORT_MIN = 1 << 16 };
+
+    /** Returns how many times to fork so that every thread gets a task */
+    static int forkDepthFor(unsigned int numThreads) {
+        int forkDepth = 0;
+        while ((1u << forkDepth) < numThreads && forkDepth < 16) {
+            forkDepth++;
+        }
+        return forkDepth;
+    }
+
+    /** Merge sorts [first, last) by less, sorting the right half on another
+     *  thread until forkDepth forks have been made along the path.
+     */
+    template <typename Iter, typename Less>
+    static void parallelSort(Iter first, Iter last, Less less,
+                             int forkDepth) {
+        if (forkDepth <= 0 || last - first < 2) {
+            sort(first, last, less);
+            return;
+        }
+        Iter mid = first + (last - first) / 2;
+        future<void> task = async(launch::async, [=]() {
+            parallelSort(mid, last, less, forkDepth - 1);
+        });
+        parallelSort(first, mid, less, forkDepth - 1);
+        task.get();
+        inplace_merge(first, mid, last, less);
+    }
+
+    /** Moves items[start] to items[end - 1], which are sorted, into a
+     *  perfectly balanced subtree rooted at their median.
+     *  @param parent Parent of the subtree's root
+     *  @return Root of the subtree, or nullptr if the range is empty
+     */
+    BSTNode<Data>* linkBalanced(vector<Data>& items, size_t start,
+                                size_t end, BSTNode<Data>* parent) {
+        if (start == end) {
+            return nullptr;
+        }
+        size_t mid = start + (end - start) / 2;
+        BSTNode<Data>* node = pool.create(std::move(items[mid]));
+        node->parent = parent;
+        node->left = linkBalanced(items, start, mid, node);
+        node->right = linkBalanced(items, mid + 1, end, node);
+        updateHeight(node);
+        return node;
+    }
+
+    /** Descends once from the root to the first node after item, or not
+     *  before it when inclusive.
+     *  @return That node, or nullptr if every item comes before it
+     */
+    BSTNode<Data>* bound(const Data& item, bool inclusive) const {
+        BSTNode<Data>* curr = root;
+        BSTNode<Data>* found = nullptr;  // smallest candidate seen so far
+        while (curr != nullptr) {
+            int order = compare(item, curr->data);
+            if (order < 0 || (order == 0 && inclusive)) {
+                found = curr;
+                if (order == 0) {
+                    break;  // nothing in the left subtree can qualify
+                }
+                curr = curr->left;
+            } else {
+                curr = curr->right;
+            }
+        }
+        return found;
+    }
+
     /** Returns the smallest or first element of BST.
      *  @param root Root in BST
      *  @return BSTNode * to smallest element in BST
@@ -163,22 +561,27 @@ class BST {
         return curr;
     }
 
-    /** Deletes all the nodes below given node in BST.
-     *  @param n Node to start deleting nodes from
+    /** Destroys all the nodes below given node in BST. Their storage is
+     *  released by the pool, so nothing needs to be done when Data has no
+     *  destructor to run.
+     *  @param n Node to start destroying nodes from
      */
     static void deleteAll(BSTNode<Data>* n) {
+        if (std::is_trivially_destructible<Data>::value) {
+            return;
+        }
         /* Pseudocode:
            if current node is null: return;
-           recursively delete left sub-tree
-           recursively delete right sub-tree
-           delete current node
+           recursively destroy left sub-tree
+           recursively destroy right sub-tree
+           destroy current node
         */
         if (n == nullptr) {
             return;
         }
         deleteAll(n->left);
         deleteAll(n->right);
-        delete (n);
+        n->~BSTNode<Data>();
     }
 };
 
@@ -10,14 +10,21 @@ class BSTIterator : public iterator<input_iterator_tag, Data> {
   private:
     BSTNode<Data>* curr;
 
+    // BST::erase needs the node an iterator points to
+    template <typename, typename, bool>
+    friend class BST;
+
   public:
     /** Constructor that initialize the current BSTNode
      *  in this BSTIterator.
      */
     BSTIterator(BSTNode<Data>* curr) : curr(curr) {}
 
-    /** Dereference operator. */
-    Data operator*() const { return curr->data; }
+    /** Dereference operator. Returns the item itself, not a copy. */
+    const Data& operator*() const { return curr->data; }
+
+    /** Member access operator. */
+    const Data* operator->() const { return &curr->data; }
 
     /** Pre-increment operator. */
     BSTIterator<Data>& operator++() {
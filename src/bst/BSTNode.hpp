@@ -2,6 +2,7 @@
 #define BSTNODE_HPP
 #include <iomanip>
 #include <iostream>
+#include <utility>
 using namespace std;
 
 template <typename Data>
@@ -11,13 +12,24 @@ class BSTNode {
     BSTNode<Data>* left;
     BSTNode<Data>* right;
     BSTNode<Data>* parent;
-    Data const data;  // the const Data in this node.
+    Data const data;     // the const Data in this node.
+    int height;          // height of the subtree rooted here, 0 for a leaf
+    unsigned int count;  // nodes in the subtree rooted here, if counted
 
     /** Constructor.
      * Initialize a BSTNode with given Data, with no parent and no children.
      * @param d Data/element of this node.
      */
-    BSTNode(const Data& d) : data(d) { left = right = parent = nullptr; }
+    BSTNode(const Data& d) : data(d), height(0), count(1) {
+        left = right = parent = nullptr;
+    }
+
+    /** Constructor that moves the given Data into this node.
+     * @param d Data/element of this node.
+     */
+    BSTNode(Data&& d) : data(std::move(d)), height(0), count(1) {
+        left = right = parent = nullptr;
+    }
 
     /** Returns the successor of this BSTNode.
      * The successor is the node with the smallest element that is larger than
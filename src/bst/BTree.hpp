@@ -0,0 +1,390 @@
+#ifndef BTREE_HPP
+#define BTREE_HPP
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include "NodePool.hpp"
+using namespace std;
+
+/** Ordered set stored as a B+ tree, with the same interface as BST.
+ *
+ *  Every node holds up to MAX_KEYS sorted keys in one array, sized so that
+ *  a node's keys span a few cache lines, so a lookup does a binary search
+ *  inside each node and touches about log_{MAX_KEYS}(n) nodes instead of
+ *  log_2(n). All items live in the leaves, which are linked in order, and
+ *  inner nodes only hold copies of the first key of each child but the
+ *  first to route searches.
+ */
+template <typename Data>
+class BTree {
+  private:
+    // bytes of keys per node, four cache lines
+    enum { NODE_BYTES = 256 };
+
+  public:
+    // largest number of keys in a node
+    enum : unsigned int {
+        MAX_KEYS =
+            NODE_BYTES / sizeof(Data) < 4 ? 4 : NODE_BYTES / sizeof(Data)
+    };
+
+  private:
+    /** Part shared by leaves and inner nodes */
+    struct Node {
+        unsigned int count;  // number of keys in use
+        bool leaf;
+        Data keys[MAX_KEYS];
+
+        Node(bool leaf) : count(0), leaf(leaf) {}
+    };
+
+    /** Leaf, holding items and a link to the next leaf in order */
+    struct Leaf : Node {
+        Leaf* next;
+
+        Leaf() : Node(true), next(nullptr) {}
+    };
+
+    /** Inner node. Keys in children[i] are at least keys[i - 1] and less
+     *  than keys[i].
+     */
+    struct Inner : Node {
+        Node* children[MAX_KEYS + 1];
+
+        Inner() : Node(false) {}
+    };
+
+    // root of the tree, or nullptr if the tree is empty
+    Node* root;
+
+    // number of Data items stored in this tree
+    unsigned int isize;
+
+    // height of this tree: -1 when empty, 0 when the root is a leaf
+    int iheight;
+
+    // storage that every node is allocated from
+    NodePool<Leaf> leaves;
+    NodePool<Inner> inners;
+
+  public:
+    /** Iterator over the items of a BTree in order */
+    class iterator : public std::iterator<input_iterator_tag, Data> {
+      private:
+        const Leaf* leaf;
+        unsigned int index;
+
+      public:
+        /** Constructor of an iterator at keys[index] of leaf, or past the
+         *  last item if leaf is nullptr.
+         */
+        iterator(const Leaf* leaf, unsigned int index)
+            : leaf(leaf), index(index) {}
+
+        /** Dereference operator. */
+        const Data& operator*() const { return leaf->keys[index]; }
+
+        /** Member access operator. */
+        const Data* operator->() const { return &leaf->keys[index]; }
+
+        /** Pre-increment operator. */
+        iterator& operator++() {
+            if (++index == leaf->count) {
+                leaf = leaf->next;
+                index = 0;
+            }
+            return *this;
+        }
+
+        /** Post-increment operator. */
+        iterator operator++(int) {
+            iterator before = *this;
+            ++(*this);
+            return before;
+        }
+
+        /** Checks for equality between positions */
+        bool operator==(const iterator& other) const {
+            return leaf == other.leaf && index == other.index;
+        }
+
+        /** Checks for inequality between positions */
+        bool operator!=(const iterator& other) const {
+            return !(*this == other);
+        }
+    };
+
+    /** Default constructor.
+     *  Initialize an empty tree.
+     */
+    BTree() : root(nullptr), isize(0), iheight(-1) {}
+
+    /** A BTree owns its nodes, so it cannot be copied */
+    BTree(const BTree&) = delete;
+    BTree& operator=(const BTree&) = delete;
+
+    /** Deconstructor.
+     *  Destroys every node, then the pools release their storage in bulk.
+     */
+    ~BTree() { deleteAll(root); }
+
+    /** Inserts an item into the tree in the correct order.
+     *  @param item Data to insert
+     *  @return True if successfully inserted. False if duplicate insertion.
+     */
+    bool insert(const Data& item) {
+        if (root == nullptr) {
+            root = leaves.create();
+            iheight = 0;
+        }
+        Data separator;
+        Node* sibling = nullptr;
+        if (!insertHelper(root, item, separator, sibling)) {
+            return false;
+        }
+
+        // the root was split, so grow the tree by one level
+        if (sibling != nullptr) {
+            Inner* newRoot = inners.create();
+            newRoot->keys[0] = separator;
+            newRoot->children[0] = root;
+            newRoot->children[1] = sibling;
+            newRoot->count = 1;
+            root = newRoot;
+            iheight++;
+        }
+        ++isize;
+        return true;
+    }
+
+    /** Find a Data item in the tree.
+     *  @param item Data to be found
+     *  @return iterator pointing to the item, or end() if not found.
+     */
+    iterator find(const Data& item) const {
+        if (root == nullptr) {
+            return end();
+        }
+        const Leaf* leaf = leafFor(item);
+        unsigned int index =
+            std::lower_bound(leaf->keys, leaf->keys + leaf->count, item) -
+            leaf->keys;
+        if (index == leaf->count || item < leaf->keys[index]) {
+            return end();
+        }
+        return iterator(leaf, index);
+    }
+
+    /** Finds the first item that is not before the given one.
+     *  @param item Data to compare the items with
+     *  @return iterator to the smallest item not before item, or end()
+     */
+    iterator lower_bound(const Data& item) const {
+        if (root == nullptr) {
+            return end();
+        }
+        const Leaf* leaf = leafFor(item);
+        unsigned int index =
+            std::lower_bound(leaf->keys, leaf->keys + leaf->count, item) -
+            leaf->keys;
+        return positionIn(leaf, index);
+    }
+
+    /** Finds the first item that is after the given one.
+     *  @param item Data to compare the items with
+     *  @return iterator to the smallest item after item, or end()
+     */
+    iterator upper_bound(const Data& item) const {
+        if (root == nullptr) {
+            return end();
+        }
+        const Leaf* leaf = leafFor(item);
+        unsigned int index =
+            std::upper_bound(leaf->keys, leaf->keys + leaf->count, item) -
+            leaf->keys;
+        return positionIn(leaf, index);
+    }
+
+    /** Finds the range of items equal to the given one, which holds one
+     *  item at most since a BTree keeps no duplicates.
+     *  @param item Data to compare the items with
+     *  @return lower_bound(item) and upper_bound(item)
+     */
+    pair<iterator, iterator> equal_range(const Data& item) const {
+        return make_pair(lower_bound(item), upper_bound(item));
+    }
+
+    /** Returns the number of items currently in the tree. */
+    unsigned int size() const { return isize; }
+
+    /** Returns the height of the tree in nodes. Empty tree has height -1 and
+     *  a tree that is a single leaf has height 0.
+     */
+    int height() const { return iheight; }
+
+    /** Returns if the tree is empty or not with 0 items. */
+    bool empty() const { return isize == 0; }
+
+    /** Return an iterator pointing to the smallest item. */
+    iterator begin() const { return iterator(firstLeaf(), 0); }
+
+    /** Return an iterator pointing past the last item. */
+    iterator end() const { return iterator(nullptr, 0); }
+
+    /** Returns the items of the tree in order from smallest to largest. */
+    vector<Data> inorder() const {
+        vector<Data> order;
+        order.reserve(isize);
+        for (const Leaf* leaf = firstLeaf(); leaf != nullptr;
+             leaf = leaf->next) {
+            order.insert(order.end(), leaf->keys, leaf->keys + leaf->count);
+        }
+        return order;
+    }
+
+  private:
+    /** Returns the leaf whose range of keys holds item, in a nonempty tree.
+     *  An item after every key of that leaf comes before the first key of
+     *  the next leaf.
+     */
+    const Leaf* leafFor(const Data& item) const {
+        const Node* node = root;
+        while (!node->leaf) {
+            const Inner* inner = static_cast<const Inner*>(node);
+            unsigned int child =
+                std::upper_bound(inner->keys, inner->keys + inner->count,
+                                 item) -
+                inner->keys;
+            node = inner->children[child];
+        }
+        return static_cast<const Leaf*>(node);
+    }
+
+    /** Returns an iterator to keys[index] of leaf, moving to the start of
+     *  the next leaf when index is past the last key.
+     */
+    static iterator positionIn(const Leaf* leaf, unsigned int index) {
+        if (index == leaf->count) {
+            return iterator(leaf->next, 0);
+        }
+        return iterator(leaf, index);
+    }
+
+    /** Returns the leftmost leaf, or nullptr if the tree is empty */
+    const Leaf* firstLeaf() const {
+        if (isize == 0) {
+            return nullptr;
+        }
+        const Node* node = root;
+        while (!node->leaf) {
+            node = static_cast<const Inner*>(node)->children[0];
+        }
+        return static_cast<const Leaf*>(node);
+    }
+
+    /** Inserts value at position index of a node with room for it */
+    static void insertKey(Node* node, unsigned int index, const Data& value) {
+        move_backward(node->keys + index, node->keys + node->count,
+                      node->keys + node->count + 1);
+        node->keys[index] = value;
+        node->count++;
+    }
+
+    /** Inserts an item into the subtree of node. A full node is split in
+     *  half first; the new right half and the key that separates it from
+     *  node are then passed up for the parent to add.
+     *  @param separator Set to the smallest key under sibling on a split
+     *  @param sibling Set to the new right half on a split, else nullptr
+     *  @return false if the item is already in the tree
+     */
+    bool insertHelper(Node* node, const Data& item, Data& separator,
+                      Node*& sibling) {
+        if (node->leaf) {
+            Leaf* leaf = static_cast<Leaf*>(node);
+            unsigned int index =
+                std::lower_bound(leaf->keys, leaf->keys + leaf->count, item) -
+                leaf->keys;
+            if (index < leaf->count && !(item < leaf->keys[index])) {
+                return false;
+            }
+            if (leaf->count < MAX_KEYS) {
+                insertKey(leaf, index, item);
+                return true;
+            }
+
+            // split into halves, then insert into the half it belongs in
+            Leaf* right = leaves.create();
+            unsigned int mid = MAX_KEYS / 2;
+            move(leaf->keys + mid, leaf->keys + MAX_KEYS, right->keys);
+            right->count = MAX_KEYS - mid;
+            leaf->count = mid;
+            right->next = leaf->next;
+            leaf->next = right;
+            if (index <= mid) {
+                insertKey(leaf, index, item);
+            } else {
+                insertKey(right, index - mid, item);
+            }
+            separator = right->keys[0];
+            sibling = right;
+            return true;
+        }
+
+        Inner* inner = static_cast<Inner*>(node);
+        unsigned int index =
+            std::upper_bound(inner->keys, inner->keys + inner->count, item) -
+            inner->keys;
+        Data childSeparator;
+        Node* childSibling = nullptr;
+        if (!insertHelper(inner->children[index], item, childSeparator,
+                          childSibling)) {
+            return false;
+        }
+        if (childSibling == nullptr) {
+            return true;
+        }
+
+        Inner* target = inner;
+        if (inner->count == MAX_KEYS) {
+            // split around the middle key, which moves up to the parent
+            Inner* right = inners.create();
+            unsigned int mid = MAX_KEYS / 2;
+            separator = inner->keys[mid];
+            move(inner->keys + mid + 1, inner->keys + MAX_KEYS, right->keys);
+            copy(inner->children + mid + 1, inner->children + MAX_KEYS + 1,
+                 right->children);
+            right->count = MAX_KEYS - mid - 1;
+            inner->count = mid;
+            sibling = right;
+            if (index > mid) {
+                target = right;
+                index -= mid + 1;
+            }
+        }
+        copy_backward(target->children + index + 1,
+                      target->children + target->count + 1,
+                      target->children + target->count + 2);
+        target->children[index + 1] = childSibling;
+        insertKey(target, index, childSeparator);
+        return true;
+    }
+
+    /** Destroys every node below and including n */
+    void deleteAll(Node* n) {
+        if (n == nullptr) {
+            return;
+        }
+        if (n->leaf) {
+            leaves.destroy(static_cast<Leaf*>(n));
+            return;
+        }
+        Inner* inner = static_cast<Inner*>(n);
+        for (unsigned int i = 0; i <= inner->count; i++) {
+            deleteAll(inner->children[i]);
+        }
+        inners.destroy(inner);
+    }
+};
+
+#endif  // BTREE_HPP
@@ -0,0 +1,309 @@
+#ifndef CONCURRENTBST_HPP
+#define CONCURRENTBST_HPP
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <utility>
+#include "NodePool.hpp"
+#include "ThreeWayCompare.hpp"
+using namespace std;
+
+/** AVL balanced set that many threads can search while one thread at a time
+ *  inserts.
+ *
+ *  Writers take a mutex. Lookups take no lock: they walk the tree through
+ *  atomic child links and validate against a version counter, as in a
+ *  seqlock. The counter is odd while a writer rotates nodes and is bumped
+ *  again when it is done, so a lookup that overlapped a rotation sees a
+ *  different version at the end and retries. Linking a new leaf needs no
+ *  version bump: its node is fully built before the link to it is stored,
+ *  so a lookup either sees it or not, and both answers are correct.
+ *
+ *  Nodes are never freed while the tree is alive, since a lookup may still
+ *  be reading any of them; for that reason there is no erase.
+ */
+template <typename Data, typename Compare = ThreeWayCompare<Data>>
+class ConcurrentBST {
+  private:
+    /** Node whose child links may be read while a writer changes them. The
+     *  parent link and height are only used by the writer.
+     */
+    struct Node {
+        atomic<Node*> left;
+        atomic<Node*> right;
+        Node* parent;
+        int height;
+        Data const data;
+
+        template <typename Item>
+        Node(Item&& item)
+            : left(nullptr),
+              right(nullptr),
+              parent(nullptr),
+              height(0),
+              data(std::forward<Item>(item)) {}
+    };
+
+    // optimistic attempts a lookup makes before it takes the writer lock
+    enum { MAX_ATTEMPTS = 8 };
+
+    // steps after which a lookup is known to have seen a rotation midway;
+    // an AVL tree of 2^32 nodes is less than 47 levels high
+    enum { MAX_STEPS = 64 };
+
+    // root of the tree, or nullptr if the tree is empty
+    atomic<Node*> root;
+
+    // even while no rotation is in progress
+    atomic<unsigned int> version;
+
+    // number of items and height, readable from any thread
+    atomic<unsigned int> isize;
+    atomic<int> iheight;
+
+    // serializes writers, and lookups that keep failing validation
+    mutable mutex writeLock;
+
+    // storage that every node is allocated from, only used by writers
+    NodePool<Node> pool;
+
+    // three-way comparator that orders the items
+    Compare compare;
+
+  public:
+    /** Default constructor.
+     *  Initialize an empty tree.
+     *  @param compare Three-way comparator that orders the items
+     */
+    ConcurrentBST(const Compare& compare = Compare())
+        : root(nullptr),
+          version(0),
+          isize(0),
+          iheight(-1),
+          compare(compare) {}
+
+    /** A ConcurrentBST owns its nodes, so it cannot be copied */
+    ConcurrentBST(const ConcurrentBST&) = delete;
+    ConcurrentBST& operator=(const ConcurrentBST&) = delete;
+
+    /** Deconstructor. Must not run while other threads use the tree. */
+    ~ConcurrentBST() { deleteAll(root.load()); }
+
+    /** Inserts an item. Blocks while another insert is running.
+     *  @param item Data to copy into the tree
+     *  @return True if inserted. False if duplicate insertion.
+     */
+    bool insert(const Data& item) { return insertItem(item); }
+
+    /** Inserts an item, moving it into its node.
+     *  @param item Data to move into the tree
+     *  @return True if inserted. False if duplicate insertion, in which case
+     *          item is left unchanged.
+     */
+    bool insert(Data&& item) { return insertItem(std::move(item)); }
+
+    /** Returns whether an item is in the tree, without locking unless
+     *  writers keep restructuring the tree during the search.
+     *  @param item Data to look for
+     */
+    bool contains(const Data& item) const {
+        for (int attempt = 0; attempt < MAX_ATTEMPTS; attempt++) {
+            unsigned int before = version.load(memory_order_acquire);
+            if (before % 2 == 1) {
+                continue;  // a rotation is in progress
+            }
+            bool complete;
+            bool found = search(item, complete);
+            atomic_thread_fence(memory_order_acquire);
+            if (complete && version.load(memory_order_relaxed) == before) {
+                return found;
+            }
+        }
+        lock_guard<mutex> guard(writeLock);
+        bool complete;
+        return search(item, complete);
+    }
+
+    /** Returns the number of items in the tree. */
+    unsigned int size() const { return isize.load(memory_order_relaxed); }
+
+    /** Returns the height of the tree. Empty tree has height -1. */
+    int height() const { return iheight.load(memory_order_relaxed); }
+
+    /** Returns if the tree is empty or not with 0 items. */
+    bool empty() const { return size() == 0; }
+
+  private:
+    /** Walks down from the root looking for item.
+     *  @param complete Set to false if the walk took so many steps that it
+     *                  must have crossed a rotation
+     *  @return whether a node holding item was reached
+     */
+    bool search(const Data& item, bool& complete) const {
+        Node* curr = root.load(memory_order_acquire);
+        for (int steps = 0; curr != nullptr; steps++) {
+            if (steps == MAX_STEPS) {
+                complete = false;
+                return false;
+            }
+            int order = compare(item, curr->data);
+            if (order == 0) {
+                complete = true;
+                return true;
+            }
+            curr = (order < 0 ? curr->left : curr->right)
+                       .load(memory_order_acquire);
+        }
+        complete = true;
+        return false;
+    }
+
+    /** Links a new leaf for item, then rebalances on the way up */
+    template <typename Item>
+    bool insertItem(Item&& item) {
+        lock_guard<mutex> guard(writeLock);
+        Node* curr = root.load(memory_order_relaxed);
+        Node* prev = nullptr;
+        int order = 0;
+        while (curr != nullptr) {
+            prev = curr;
+            order = compare(item, curr->data);
+            if (order == 0) {
+                return false;
+            }
+            curr = (order < 0 ? curr->left : curr->right)
+                       .load(memory_order_relaxed);
+        }
+
+        // the release store publishes the fully built node
+        Node* node = pool.create(std::forward<Item>(item));
+        node->parent = prev;
+        if (prev == nullptr) {
+            root.store(node, memory_order_release);
+        } else if (order < 0) {
+            prev->left.store(node, memory_order_release);
+        } else {
+            prev->right.store(node, memory_order_release);
+        }
+        fixUp(prev);
+        isize.store(isize.load(memory_order_relaxed) + 1,
+                    memory_order_relaxed);
+        iheight.store(heightOf(root.load(memory_order_relaxed)),
+                      memory_order_relaxed);
+        return true;
+    }
+
+    /** Returns the height of a subtree, -1 for an empty one */
+    static int heightOf(Node* n) { return n == nullptr ? -1 : n->height; }
+
+    /** Returns the left child of n as seen by the writer */
+    static Node* leftOf(Node* n) { return n->left.load(memory_order_relaxed); }
+
+    /** Returns the right child of n as seen by the writer */
+    static Node* rightOf(Node* n) {
+        return n->right.load(memory_order_relaxed);
+    }
+
+    /** Recomputes the height of a node from the heights of its children */
+    static void updateHeight(Node* n) {
+        n->height = 1 + max(heightOf(leftOf(n)), heightOf(rightOf(n)));
+    }
+
+    /** Returns how much taller the left subtree of a node is than its right
+     */
+    static int balanceOf(Node* n) {
+        return heightOf(leftOf(n)) - heightOf(rightOf(n));
+    }
+
+    /** Restores heights from node upwards, rotating unbalanced nodes with
+     *  the version held odd, until a height stays the same.
+     */
+    void fixUp(Node* node) {
+        while (node != nullptr) {
+            int oldHeight = node->height;
+            updateHeight(node);
+            int balance = balanceOf(node);
+            if (balance > 1 || balance < -1) {
+                unsigned int v = version.load(memory_order_relaxed);
+                version.store(v + 1, memory_order_relaxed);
+                atomic_thread_fence(memory_order_release);
+                if (balance > 1) {
+                    if (balanceOf(leftOf(node)) < 0) {  // left-right case
+                        rotateLeft(leftOf(node));
+                    }
+                    node = rotateRight(node);
+                } else {
+                    if (balanceOf(rightOf(node)) > 0) {  // right-left case
+                        rotateRight(rightOf(node));
+                    }
+                    node = rotateLeft(node);
+                }
+                version.store(v + 2, memory_order_release);
+            }
+            if (node->height == oldHeight) {
+                return;
+            }
+            node = node->parent;
+        }
+    }
+
+    /** Puts child in the place of node under node's parent, or as root */
+    void replaceChild(Node* node, Node* child) {
+        child->parent = node->parent;
+        if (node->parent == nullptr) {
+            root.store(child, memory_order_release);
+        } else if (leftOf(node->parent) == node) {
+            node->parent->left.store(child, memory_order_release);
+        } else {
+            node->parent->right.store(child, memory_order_release);
+        }
+    }
+
+    /** Rotates the right child of a node up into its place.
+     *  @return The node now at the top of the rotated subtree
+     */
+    Node* rotateLeft(Node* node) {
+        Node* child = rightOf(node);
+        Node* inner = leftOf(child);
+        node->right.store(inner, memory_order_release);
+        if (inner != nullptr) {
+            inner->parent = node;
+        }
+        replaceChild(node, child);
+        child->left.store(node, memory_order_release);
+        node->parent = child;
+        updateHeight(node);
+        updateHeight(child);
+        return child;
+    }
+
+    /** Rotates the left child of a node up into its place.
+     *  @return The node now at the top of the rotated subtree
+     */
+    Node* rotateRight(Node* node) {
+        Node* child = leftOf(node);
+        Node* inner = rightOf(child);
+        node->left.store(inner, memory_order_release);
+        if (inner != nullptr) {
+            inner->parent = node;
+        }
+        replaceChild(node, child);
+        child->right.store(node, memory_order_release);
+        node->parent = child;
+        updateHeight(node);
+        updateHeight(child);
+        return child;
+    }
+
+    /** Destroys every node below and including n */
+    void deleteAll(Node* n) {
+        if (n == nullptr) {
+            return;
+        }
+        deleteAll(leftOf(n));
+        deleteAll(rightOf(n));
+        pool.destroy(n);
+    }
+};
+
+#endif  // CONCURRENTBST_HPP
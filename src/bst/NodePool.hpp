@@ -0,0 +1,101 @@
+#ifndef NODEPOOL_HPP
+#define NODEPOOL_HPP
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+using namespace std;
+
+/** Pool that hands out storage for tree nodes from large contiguous chunks.
+ *  Nodes never move once created, so pointers to them stay valid. Freed
+ *  nodes are kept on a free list for reuse, and every chunk is released at
+ *  once when the pool is cleared or destroyed.
+ */
+template <typename Node>
+class NodePool {
+  private:
+    /** Storage for one node, also used as a free list link when unused */
+    union Slot {
+        Slot* next;
+        alignas(Node) unsigned char storage[sizeof(Node)];
+    };
+
+    // number of slots in the first chunk, doubled up to MAX_CHUNK after that
+    enum { FIRST_CHUNK = 16, MAX_CHUNK = 4096 };
+
+    // every chunk allocated so far, and the number of slots in the last one
+    vector<Slot*> chunks;
+    size_t chunkSize;
+
+    // next unused slot in the newest chunk and how many slots it has left
+    Slot* nextSlot;
+    size_t slotsLeft;
+
+    // slots given back by destroy
+    Slot* freeList;
+
+  public:
+    /** Constructor of an empty pool */
+    NodePool()
+        : chunkSize(0), nextSlot(nullptr), slotsLeft(0), freeList(nullptr) {}
+
+    /** A pool owns its chunks, so it cannot be copied */
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    /** Destructor. Releases the storage of every node without destroying
+     *  them; the owner must destroy nodes that need it first.
+     */
+    ~NodePool() { clear(); }
+
+    /** Constructs a node in pool storage with the given arguments.
+     *  @return Pointer to the new node
+     */
+    template <typename... Args>
+    Node* create(Args&&... args) {
+        Slot* slot;
+        if (freeList != nullptr) {  // reuse a freed slot first
+            slot = freeList;
+            freeList = freeList->next;
+        } else {
+            if (slotsLeft == 0) {
+                if (chunkSize == 0) {
+                    chunkSize = FIRST_CHUNK;
+                } else if (chunkSize < MAX_CHUNK) {
+                    chunkSize *= 2;
+                }
+                nextSlot = static_cast<Slot*>(
+                    ::operator new(chunkSize * sizeof(Slot)));
+                chunks.push_back(nextSlot);
+                slotsLeft = chunkSize;
+            }
+            slot = nextSlot++;
+            --slotsLeft;
+        }
+        return new (slot->storage) Node(std::forward<Args>(args)...);
+    }
+
+    /** Destroys a node and returns its storage to the pool.
+     *  @param node Node created by this pool
+     */
+    void destroy(Node* node) {
+        node->~Node();
+        Slot* slot = reinterpret_cast<Slot*>(node);
+        slot->next = freeList;
+        freeList = slot;
+    }
+
+    /** Releases every chunk at once without destroying the nodes in them */
+    void clear() {
+        for (Slot* chunk : chunks) {
+            ::operator delete(chunk);
+        }
+        chunks.clear();
+        chunkSize = 0;
+        nextSlot = nullptr;
+        slotsLeft = 0;
+        freeList = nullptr;
+    }
+};
+
+#endif  // NODEPOOL_HPP
@@ -0,0 +1,26 @@
+#ifndef THREEWAYCOMPARE_HPP
+#define THREEWAYCOMPARE_HPP
+#include <string>
+using namespace std;
+
+/** Default comparator of BST. Returns a negative number if a sorts before
+ *  b, zero if they are equal and a positive number if a sorts after b, so
+ *  one call decides which way to go at a node. The generic version is
+ *  built from operator< and calls it twice when a is not smaller.
+ */
+template <typename Data>
+struct ThreeWayCompare {
+    int operator()(const Data& a, const Data& b) const {
+        return a < b ? -1 : (b < a ? 1 : 0);
+    }
+};
+
+/** Strings are compared in one pass with string::compare */
+template <>
+struct ThreeWayCompare<string> {
+    int operator()(const string& a, const string& b) const {
+        return a.compare(b);
+    }
+};
+
+#endif  // THREEWAYCOMPARE_HPP
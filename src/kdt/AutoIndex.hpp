@@ -0,0 +1,133 @@
+/**
+ * Nearest neighbor index that picks a brute force scan or a KD tree for each
+ * data set.
+ *
+ * Small data sets, and data sets with too few points per dimension for KD
+ * tree pruning to work, always use brute force. Otherwise both engines are
+ * built and timed on a sample of queries, and the faster one is kept.
+ */
+
+#ifndef AutoIndex_hpp
+#define AutoIndex_hpp
+
+#include <chrono>
+#include <memory>
+#include <random>
+#include <vector>
+#include "BruteForce.hpp"
+#include "KDT.hpp"
+#include "Metric.hpp"
+#include "Point.hpp"
+
+using namespace std;
+
+template <class Metric = SquaredEuclidean>
+class BasicAutoIndex {
+  private:
+    // data sets smaller than this always use brute force
+    enum { MIN_KDT_SIZE = 1024 };
+
+    // a KD tree needs at least this many points per cell split, 2^numDim
+    enum { MIN_POINTS_PER_SPLIT = 16 };
+
+    // number of queries timed on each engine during calibration
+    enum { NUM_CALIBRATION_QUERIES = 32 };
+
+    Metric metric;
+    unique_ptr<BasicBruteForce<Metric>> bruteForce;
+    unique_ptr<BasicKDT<Metric>> kdt;
+
+  public:
+    /** Constructor of an empty index
+     *  @param metric Distance metric used for nearest neighbor search
+     */
+    BasicAutoIndex(const Metric& metric = Metric()) : metric(metric) {}
+
+    /** Builds the engine that suits the points best.
+     *  @param points Vector of points to search
+     */
+    void build(vector<Point>& points) {
+        bruteForce.reset(new BasicBruteForce<Metric>(metric));
+        bruteForce->build(points);
+        kdt.reset();
+        if (points.size() < MIN_KDT_SIZE) {
+            return;
+        }
+
+        // a KD tree only prunes well once there are many points per split
+        unsigned int numDim = points[0].numDim;
+        if (numDim >= 32 ||
+            (points.size() >> numDim) < MIN_POINTS_PER_SPLIT) {
+            return;
+        }
+
+        kdt.reset(new BasicKDT<Metric>(metric));
+        vector<Point> buildPoints = points;
+        kdt->build(buildPoints);
+
+        // calibrate on midpoints between random pairs of points, which lie
+        // in the populated part of the space without being data points
+        mt19937 rng(points.size());
+        uniform_int_distribution<size_t> pick(0, points.size() - 1);
+        vector<Point> queries;
+        for (int i = 0; i < NUM_CALIBRATION_QUERIES; i++) {
+            vector<double> features = points[pick(rng)].features;
+            const vector<double>& other = points[pick(rng)].features;
+            for (unsigned int d = 0; d < numDim; d++) {
+                features[d] = (features[d] + other[d]) / 2;
+            }
+            queries.push_back(Point(features));
+        }
+        if (timeQueries(*bruteForce, queries) < timeQueries(*kdt, queries)) {
+            kdt.reset();
+        } else {
+            bruteForce.reset();
+        }
+    }
+
+    /** Returns a pointer to the nearest neighbor of the query point, or
+     *  nullptr if the index is empty.
+     *  @param queryPoint Query point to find the nearest neighbor of
+     */
+    Point* findNearestNeighbor(Point& queryPoint) {
+        if (kdt) return kdt->findNearestNeighbor(queryPoint);
+        if (bruteForce) return bruteForce->findNearestNeighbor(queryPoint);
+        return nullptr;
+    }
+
+    /** Returns all points inside the query region.
+     *  @param queryRegion The query region to perform region search
+     */
+    vector<Point> rangeSearch(vector<pair<double, double>>& queryRegion) {
+        if (kdt) return kdt->rangeSearch(queryRegion);
+        if (bruteForce) return bruteForce->rangeSearch(queryRegion);
+        return vector<Point>();
+    }
+
+    /** Returns the number of points in the index */
+    unsigned int size() const {
+        if (kdt) return kdt->size();
+        return bruteForce ? bruteForce->size() : 0;
+    }
+
+    /** Returns true if the KD tree was picked, false for brute force */
+    bool usesKDT() const { return kdt != nullptr; }
+
+  private:
+    /** Returns the nanoseconds taken to answer every query with engine */
+    template <class Engine>
+    static long long timeQueries(Engine& engine, vector<Point>& queries) {
+        auto start = chrono::steady_clock::now();
+        for (Point& query : queries) {
+            engine.findNearestNeighbor(query);
+        }
+        return chrono::duration_cast<chrono::nanoseconds>(
+                   chrono::steady_clock::now() - start)
+            .count();
+    }
+};
+
+/** Automatically selected index using squared Euclidean distance */
+typedef BasicAutoIndex<SquaredEuclidean> AutoIndex;
+
+#endif /* AutoIndex_hpp */
@@ -0,0 +1,229 @@
+/**
+ * Brute force nearest neighbor and range search engine.
+ *
+ * Points are copied into blocks of BLOCK points stored dimension by
+ * dimension, so the distances from a query to a whole block are computed
+ * with one vectorizable loop per dimension. Large scans are split across
+ * threads.
+ */
+
+#ifndef BruteForce_hpp
+#define BruteForce_hpp
+
+#include <limits>
+#include <thread>
+#include <vector>
+#include "Metric.hpp"
+#include "Point.hpp"
+
+using namespace std;
+
+template <class Metric = SquaredEuclidean>
+class BasicBruteForce {
+  private:
+    // number of points whose distances are computed together
+    enum { BLOCK = 8 };
+
+    // scans with fewer feature values than this stay on one thread
+    enum { PARALLEL_MIN_VALUES = 1 << 20 };
+
+    // the points, in input order
+    vector<Point> points;
+
+    // point j of block b has its value at dimension d stored at
+    // blocks[(b * numDim + d) * BLOCK + j]; the last block is zero padded
+    vector<double> blocks;
+
+    unsigned int numDim;
+    unsigned int numBlocks;
+    unsigned int numThreads;
+
+    // distance metric used for searching
+    Metric metric;
+
+  public:
+    /** Constructor of an empty brute force engine
+     *  @param metric Distance metric used for nearest neighbor search
+     *  @param numThreads Number of threads used by large scans
+     */
+    BasicBruteForce(const Metric& metric = Metric(),
+                    unsigned int numThreads = thread::hardware_concurrency())
+        : numDim(0),
+          numBlocks(0),
+          numThreads(numThreads == 0 ? 1 : numThreads),
+          metric(metric) {}
+
+    /** Copies the points into the blocked layout used for scanning.
+     *  @param points Vector of points to search
+     */
+    void build(vector<Point>& points) {
+        this->points = points;
+        blocks.clear();
+        numBlocks = 0;
+        if (points.empty()) {
+            return;
+        }
+        numDim = points[0].numDim;
+        numBlocks = (points.size() + BLOCK - 1) / BLOCK;
+        blocks.assign((size_t)numBlocks * numDim * BLOCK, 0);
+        for (size_t i = 0; i < points.size(); i++) {
+            size_t base = (i / BLOCK) * numDim * BLOCK + i % BLOCK;
+            for (unsigned int d = 0; d < numDim; d++) {
+                blocks[base + (size_t)d * BLOCK] = points[i].features[d];
+            }
+        }
+    }
+
+    /** Returns a pointer to the nearest neighbor of the query point, or
+     *  nullptr if there are no points. Ties go to the earliest point.
+     *  @param queryPoint Query point to find the nearest neighbor of
+     */
+    Point* findNearestNeighbor(Point& queryPoint) {
+        if (points.empty()) {
+            return nullptr;
+        }
+
+        unsigned int tasks = numTasks();
+        vector<double> bestDist(tasks, numeric_limits<double>::max());
+        vector<size_t> bestIndex(tasks, 0);
+        runTasks(tasks, [&](unsigned int task, unsigned int start,
+                            unsigned int end) {
+            scanNearest(queryPoint.features.data(), start, end,
+                        bestDist[task], bestIndex[task]);
+        });
+
+        // tasks cover increasing blocks, so a strict < keeps the earliest
+        unsigned int best = 0;
+        for (unsigned int task = 1; task < tasks; task++) {
+            if (bestDist[task] < bestDist[best]) best = task;
+        }
+        Point& nearest = points[bestIndex[best]];
+        nearest.distToQuery = bestDist[best];
+        return &nearest;
+    }
+
+    /** Returns all points inside the query region, in input order.
+     *  @param queryRegion The query region to perform region search
+     */
+    vector<Point> rangeSearch(vector<pair<double, double>>& queryRegion) {
+        if (points.empty()) {
+            return vector<Point>();
+        }
+
+        unsigned int tasks = numTasks();
+        vector<vector<size_t>> hits(tasks);
+        runTasks(tasks, [&](unsigned int task, unsigned int start,
+                            unsigned int end) {
+            scanRange(queryRegion, start, end, hits[task]);
+        });
+
+        vector<Point> result;
+        for (vector<size_t>& taskHits : hits) {
+            for (size_t i : taskHits) {
+                result.push_back(points[i]);
+            }
+        }
+        return result;
+    }
+
+    /** Returns the number of points */
+    unsigned int size() const { return points.size(); }
+
+  private:
+    /** Returns how many tasks a scan over every block is split into */
+    unsigned int numTasks() const {
+        if ((size_t)numBlocks * BLOCK * numDim < PARALLEL_MIN_VALUES) {
+            return 1;
+        }
+        return numThreads < numBlocks ? numThreads : numBlocks;
+    }
+
+    /** Splits the blocks evenly over tasks and runs them, the first on this
+     *  thread and the rest on their own threads.
+     *  @param scan Called with (task, first block, end block)
+     */
+    template <class Scan>
+    void runTasks(unsigned int tasks, Scan scan) const {
+        vector<thread> threads;
+        for (unsigned int task = 1; task < tasks; task++) {
+            threads.emplace_back(scan, task,
+                                 (unsigned int)((size_t)numBlocks * task /
+                                                tasks),
+                                 (unsigned int)((size_t)numBlocks *
+                                                (task + 1) / tasks));
+        }
+        scan(0, 0, numBlocks / tasks);
+        for (thread& t : threads) {
+            t.join();
+        }
+    }
+
+    /** Finds the nearest point among blocks [start, end).
+     *  @param bestDist Set to the smallest distance found
+     *  @param bestIndex Set to the index of that point
+     */
+    void scanNearest(const double* query, unsigned int start,
+                     unsigned int end, double& bestDist,
+                     size_t& bestIndex) const {
+        double dist[BLOCK];
+        for (unsigned int b = start; b < end; b++) {
+            const double* block = &blocks[(size_t)b * numDim * BLOCK];
+            // every metric distance is >= 0, which combine starts from
+            for (int j = 0; j < BLOCK; j++) dist[j] = 0;
+            for (unsigned int d = 0; d < numDim; d++) {
+                const double* values = block + d * BLOCK;
+                double q = query[d];
+                for (int j = 0; j < BLOCK; j++) {
+                    dist[j] = metric.combine(dist[j],
+                                             metric.axis(values[j] - q, d));
+                }
+            }
+
+            size_t first = (size_t)b * BLOCK;
+            int count = first + BLOCK <= points.size()
+                            ? (int)BLOCK
+                            : (int)(points.size() - first);
+            for (int j = 0; j < count; j++) {
+                if (dist[j] < bestDist) {
+                    bestDist = dist[j];
+                    bestIndex = first + j;
+                }
+            }
+        }
+    }
+
+    /** Adds the index of every point in blocks [start, end) that lies in
+     *  the query region to hits.
+     */
+    void scanRange(vector<pair<double, double>>& queryRegion,
+                   unsigned int start, unsigned int end,
+                   vector<size_t>& hits) const {
+        bool inside[BLOCK];
+        for (unsigned int b = start; b < end; b++) {
+            const double* block = &blocks[(size_t)b * numDim * BLOCK];
+            for (int j = 0; j < BLOCK; j++) inside[j] = true;
+            for (unsigned int d = 0; d < numDim; d++) {
+                const double* values = block + d * BLOCK;
+                double low = queryRegion[d].first;
+                double high = queryRegion[d].second;
+                for (int j = 0; j < BLOCK; j++) {
+                    inside[j] = inside[j] & (low <= values[j]) &
+                                (values[j] <= high);
+                }
+            }
+
+            size_t first = (size_t)b * BLOCK;
+            int count = first + BLOCK <= points.size()
+                            ? (int)BLOCK
+                            : (int)(points.size() - first);
+            for (int j = 0; j < count; j++) {
+                if (inside[j]) hits.push_back(first + j);
+            }
+        }
+    }
+};
+
+/** Brute force engine using squared Euclidean distance */
+typedef BasicBruteForce<SquaredEuclidean> BruteForce;
+
+#endif /* BruteForce_hpp */
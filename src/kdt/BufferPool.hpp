@@ -0,0 +1,128 @@
+/**
+ * Buffer pool caching fixed size pages of a file in memory.
+ *
+ * At most capacity pages are held at once. Reading a page that is not cached
+ * evicts the least recently used page and reuses its frame, so the memory
+ * used stays bounded no matter how large the file is.
+ */
+
+#ifndef BufferPool_hpp
+#define BufferPool_hpp
+
+#include <stdio.h>
+#include <sys/types.h>
+#include <limits>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+/** Moves to a byte offset of a file with 64-bit offsets, failing instead of
+ *  wrapping around if the offset does not fit in off_t.
+ *  @return true if the file position was set
+ */
+inline bool seekTo(FILE* file, unsigned long long offset) {
+    if (offset > (unsigned long long)numeric_limits<off_t>::max()) {
+        return false;
+    }
+    return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+}
+
+class BufferPool {
+  private:
+    /** One cached page */
+    struct Frame {
+        unsigned int page;
+        vector<char> data;
+    };
+
+    // cached pages, most recently used first
+    list<Frame> frames;
+
+    // position in frames of every cached page
+    unordered_map<unsigned int, list<Frame>::iterator> frameOfPage;
+
+    // file the pages are read from, and the offset of page 0 in it
+    FILE* file;
+    unsigned long long base;
+
+    size_t pageBytes;
+    size_t capacity;
+
+    unsigned long long hits;
+    unsigned long long misses;
+
+  public:
+    /** Constructor of a pool that is not attached to a file yet */
+    BufferPool()
+        : file(nullptr), base(0), pageBytes(0), capacity(0), hits(0),
+          misses(0) {}
+
+    /** A pool hands out pointers into its frames, so it cannot be copied */
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    /** Drops every cached page and reads pages of file from now on. The pool
+     *  does not own the file.
+     *  @param file File to read pages from
+     *  @param base Byte offset of page 0 in the file
+     *  @param pageBytes Size of a page in bytes
+     *  @param capacity Largest number of pages cached at once, at least 1
+     */
+    void attach(FILE* file, unsigned long long base, size_t pageBytes,
+                size_t capacity) {
+        frames.clear();
+        frameOfPage.clear();
+        this->file = file;
+        this->base = base;
+        this->pageBytes = pageBytes;
+        this->capacity = capacity == 0 ? 1 : capacity;
+        hits = 0;
+        misses = 0;
+    }
+
+    /** Returns the contents of a page, reading it from the file if it is not
+     *  cached. The pointer stays valid until the next call to fetch.
+     *  @param page Index of the page to read
+     *  @return Pointer to pageBytes bytes, or nullptr if the read failed
+     */
+    const char* fetch(unsigned int page) {
+        auto found = frameOfPage.find(page);
+        if (found != frameOfPage.end()) {
+            ++hits;
+            frames.splice(frames.begin(), frames, found->second);
+            return frames.front().data.data();
+        }
+        ++misses;
+
+        // take a new frame while below capacity, else the oldest one
+        if (frames.size() < capacity) {
+            frames.emplace_front();
+            frames.front().data.resize(pageBytes);
+        } else {
+            frameOfPage.erase(frames.back().page);
+            frames.splice(frames.begin(), frames, prev(frames.end()));
+        }
+        Frame& frame = frames.front();
+        if (!seekTo(file, base + (unsigned long long)page * pageBytes) ||
+            fread(frame.data.data(), 1, pageBytes, file) != pageBytes) {
+            frames.pop_front();
+            return nullptr;
+        }
+        frame.page = page;
+        frameOfPage[page] = frames.begin();
+        return frame.data.data();
+    }
+
+    /** Returns the number of pages currently cached */
+    size_t cached() const { return frames.size(); }
+
+    /** Returns the number of fetches served from the cache */
+    unsigned long long cacheHits() const { return hits; }
+
+    /** Returns the number of fetches that read the file */
+    unsigned long long pageReads() const { return misses; }
+};
+
+#endif /* BufferPool_hpp */
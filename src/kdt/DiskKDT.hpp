@@ -0,0 +1,716 @@
+/**
+ * Disk backed KD tree for point sets larger than memory.
+ *
+ * Only the inner nodes live in memory. The points are stored in fixed size
+ * leaf pages of an index file and read on demand through a buffer pool that
+ * caches a bounded number of pages. Since a leaf holds a whole page of points
+ * there are about pageSize / (8 * numDim) times fewer nodes than points.
+ *
+ * The index is bulk loaded from a file of points. A range of points that
+ * does not fit the memory budget is split at the median of a sample along
+ * its widest dimension, in one streaming pass that writes the two halves to
+ * the front and back of the range in a scratch file, and the halves are
+ * loaded the same way. Once a range fits in memory its subtree is built
+ * there, and its leaves are written out in order, so nearby points end up in
+ * nearby pages.
+ *
+ * Point files are the raw features of each point one after another, and
+ * index files are in native byte order, so neither is portable between
+ * machines of different endianness.
+ */
+
+#ifndef DiskKDT_hpp
+#define DiskKDT_hpp
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <vector>
+#include "BufferPool.hpp"
+#include "Metric.hpp"
+#include "Point.hpp"
+
+using namespace std;
+
+template <class Metric = SquaredEuclidean>
+class BasicDiskKDT {
+  private:
+    // index used in place of a child, root or page that does not exist
+    enum : unsigned int { NONE = 0xFFFFFFFFu };
+
+    // number of points sampled from a range to estimate its median
+    enum { SAMPLE_SIZE = 1024 };
+
+    // number of points moved per read or write while partitioning
+    enum { CHUNK_POINTS = 4096 };
+
+    /** Node of the in memory part of the tree. Leaves have a page, inner
+     *  nodes have points no larger than split on the left and no smaller on
+     *  the right.
+     */
+    struct DiskNode {
+        double split;
+        unsigned int dim;
+        unsigned int left;
+        unsigned int right;
+        unsigned int page;
+    };
+
+    /** Start of an index file. Page p is stored at (p + 1) * pageBytes and
+     *  the nodes follow the last page.
+     */
+    struct Header {
+        char magic[8];
+        unsigned int numDim;
+        unsigned int pageBytes;
+        unsigned int numPages;
+        unsigned int numNodes;
+        unsigned int root;
+        int height;
+        unsigned long long numPoints;
+    };
+
+    /** Start of a leaf page, followed by the features of count points */
+    struct PageHeader {
+        unsigned int count;
+        unsigned int unused;
+    };
+
+    // inner nodes and leaves of the tree
+    vector<DiskNode> nodes;
+
+    // index of root of the tree
+    unsigned int root;
+
+    // number of dimension of data points
+    unsigned int numDim;
+
+    // distance metric used for nearest neighbor search
+    Metric metric;
+
+    // requested page size, cache size in pages and build memory in bytes
+    size_t pageSize;
+    size_t cacheSize;
+    size_t memoryBudget;
+
+    // actual page size and number of points per page of the open index
+    size_t pageBytes;
+    size_t pageCapacity;
+    unsigned int numPages;
+
+    unsigned long long isize;
+    int iheight;
+
+    // open index file and the cache of its pages
+    FILE* file;
+    BufferPool pool;
+
+    // smallest distance to query point so far
+    double threshold;
+
+    // current nearest neighbor
+    Point nearestNeighbor;
+
+    // files read and written while bulk loading, and whether all I/O worked
+    FILE* input;
+    FILE* scratch[2];
+    FILE* out;
+    vector<char> pageBuffer;
+    bool ok;
+
+  public:
+    /** Constructor of a disk KD tree with no index open
+     *  @param metric Distance metric used for nearest neighbor search
+     */
+    BasicDiskKDT(const Metric& metric = Metric())
+        : root(NONE),
+          numDim(0),
+          metric(metric),
+          pageSize(4096),
+          cacheSize(256),
+          memoryBudget(64 << 20),
+          pageBytes(0),
+          pageCapacity(0),
+          numPages(0),
+          isize(0),
+          iheight(-1),
+          file(nullptr),
+          threshold(numeric_limits<double>::max()),
+          input(nullptr),
+          out(nullptr),
+          ok(true) {
+        scratch[0] = scratch[1] = nullptr;
+    }
+
+    /** The tree owns its open file, so it cannot be copied */
+    BasicDiskKDT(const BasicDiskKDT&) = delete;
+    BasicDiskKDT& operator=(const BasicDiskKDT&) = delete;
+
+    /** Destructor. Closes the index file. */
+    ~BasicDiskKDT() { close(); }
+
+    /** Sets the size in bytes of the leaf pages of later builds. A page
+     *  always has room for at least one point.
+     */
+    void setPageSize(size_t bytes) { pageSize = bytes; }
+
+    /** Sets the largest number of pages cached in memory, taking effect the
+     *  next time an index is opened or built.
+     */
+    void setCacheSize(size_t pages) { cacheSize = pages; }
+
+    /** Sets roughly how many bytes of points a build holds in memory at once.
+     *  Ranges larger than this are partitioned on disk.
+     */
+    void setMemoryBudget(size_t bytes) { memoryBudget = bytes; }
+
+    /** Writes points to a point file that bulkLoad can read.
+     *  @return true if every point was written
+     */
+    static bool writePoints(const string& path, const vector<Point>& points) {
+        FILE* f = fopen(path.c_str(), "wb");
+        if (f == nullptr) {
+            return false;
+        }
+        bool written = true;
+        for (const Point& point : points) {
+            written = written &&
+                      fwrite(point.features.data(), sizeof(double),
+                             point.numDim, f) == point.numDim;
+        }
+        return fclose(f) == 0 && written;
+    }
+
+    /** Builds an index of points in a file and opens it. The points pass
+     *  through a temporary point file next to the index.
+     *  @param points Vector of points to put into the index
+     *  @param indexPath Path of the index file to create
+     *  @return true if the index was built and opened
+     */
+    bool build(vector<Point>& points, const string& indexPath) {
+        string pointsPath = indexPath + ".points";
+        bool built = writePoints(pointsPath, points) &&
+                     bulkLoad(pointsPath,
+                              points.empty() ? 1 : points[0].numDim,
+                              indexPath);
+        remove(pointsPath.c_str());
+        return built;
+    }
+
+    /** Bulk loads an index from a point file and opens it. Uses two scratch
+     *  files next to the index, each as large as the point file, which are
+     *  removed afterwards.
+     *  @param inputPath Point file to read
+     *  @param numDim Number of features of each point
+     *  @param indexPath Path of the index file to create
+     *  @return true if the index was built and opened
+     */
+    bool bulkLoad(const string& inputPath, unsigned int numDim,
+                  const string& indexPath) {
+        close();
+        if (numDim == 0) {
+            return false;
+        }
+        this->numDim = numDim;
+        size_t pointBytes = numDim * sizeof(double);
+        pageCapacity = pageSize > sizeof(PageHeader)
+                           ? (pageSize - sizeof(PageHeader)) / pointBytes
+                           : 0;
+        if (pageCapacity == 0) pageCapacity = 1;
+        pageBytes = max(max(pageSize, sizeof(Header)),
+                        sizeof(PageHeader) + pageCapacity * pointBytes);
+        pageBuffer.assign(pageBytes, 0);
+
+        input = fopen(inputPath.c_str(), "rb");
+        if (input == nullptr) {
+            return false;
+        }
+        unsigned long long count = fileSize(input) / pointBytes;
+        string scratchPath[2] = {indexPath + ".0", indexPath + ".1"};
+        out = fopen(indexPath.c_str(), "wb");
+        scratch[0] = fopen(scratchPath[0].c_str(), "wb+");
+        scratch[1] = fopen(scratchPath[1].c_str(), "wb+");
+        ok = out != nullptr && scratch[0] != nullptr && scratch[1] != nullptr;
+
+        if (ok && count > 0) {
+            root = loadRange(0, 0, count, 0);
+        }
+        if (ok) {
+            Header header;
+            memset(&header, 0, sizeof(header));
+            memcpy(header.magic, "DISKKDT1", 8);
+            header.numDim = numDim;
+            header.pageBytes = pageBytes;
+            header.numPages = numPages;
+            header.numNodes = nodes.size();
+            header.root = root;
+            header.height = iheight;
+            header.numPoints = count;
+            ok = seekTo(out, nodesOffset()) &&
+                 (nodes.empty() ||
+                  fwrite(nodes.data(), sizeof(DiskNode), nodes.size(), out) ==
+                      nodes.size()) &&
+                 seekTo(out, 0) &&
+                 fwrite(&header, sizeof(header), 1, out) == 1;
+        }
+
+        fclose(input);
+        input = nullptr;
+        for (int i = 0; i < 2; i++) {
+            if (scratch[i] != nullptr) fclose(scratch[i]);
+            scratch[i] = nullptr;
+            remove(scratchPath[i].c_str());
+        }
+        if (out != nullptr && fclose(out) != 0) ok = false;
+        out = nullptr;
+        nodes.clear();
+        pageBuffer.clear();
+        return ok && open(indexPath);
+    }
+
+    /** Opens an index built earlier, loading its inner nodes into memory.
+     *  @param indexPath Path of the index file
+     *  @return true if the file is a valid index
+     */
+    bool open(const string& indexPath) {
+        close();
+        file = fopen(indexPath.c_str(), "rb");
+        if (file == nullptr) {
+            return false;
+        }
+        Header header;
+        if (fread(&header, sizeof(header), 1, file) != 1 ||
+            !headerValid(header, fileSize(file))) {
+            close();
+            return false;
+        }
+        numDim = header.numDim;
+        pageBytes = header.pageBytes;
+        pageCapacity = (pageBytes - sizeof(PageHeader)) /
+                       (numDim * sizeof(double));
+        numPages = header.numPages;
+        root = header.root;
+        iheight = header.height;
+        nodes.resize(header.numNodes);
+        if (!seekTo(file, nodesOffset()) ||
+            (!nodes.empty() &&
+             fread(nodes.data(), sizeof(DiskNode), nodes.size(), file) !=
+                 nodes.size()) ||
+            !nodesValid()) {
+            close();
+            return false;
+        }
+        isize = header.numPoints;
+        pool.attach(file, pageBytes, pageBytes, cacheSize);
+        return true;
+    }
+
+    /** Closes the open index, if any. The tree is empty afterwards. */
+    void close() {
+        if (file != nullptr) {
+            fclose(file);
+            file = nullptr;
+        }
+        pool.attach(nullptr, 0, 0, 1);
+        nodes.clear();
+        root = NONE;
+        numPages = 0;
+        isize = 0;
+        iheight = -1;
+    }
+
+    /** Returns a pointer to the nearest neighbor of a given query point, or
+     *  nullptr if the index is empty or its pages cannot be read.
+     *  @param queryPoint Query point to find the nearest neighbor of
+     */
+    Point* findNearestNeighbor(Point& queryPoint) {
+        if (isize == 0) {
+            return nullptr;
+        }
+        threshold = numeric_limits<double>::max();
+        findNNHelper(root, queryPoint.features.data());
+        if (threshold == numeric_limits<double>::max()) {
+            return nullptr;
+        }
+        nearestNeighbor.distToQuery = threshold;
+        return &nearestNeighbor;
+    }
+
+    /** Returns a vector containing all points inside query region.
+     *  @param queryRegion The query region to perform region search
+     */
+    vector<Point> rangeSearch(vector<pair<double, double>>& queryRegion) {
+        vector<Point> result;
+        if (isize != 0) {
+            rangeSearchHelper(root, queryRegion, result);
+        }
+        return result;
+    }
+
+    /** Returns the number of points in the index */
+    unsigned long long size() const { return isize; }
+
+    /** Returns the height of the tree. Empty tree has height -1 and a tree
+     *  that is a single leaf page has height 0.
+     */
+    int height() const { return iheight; }
+
+    /** Returns the number of leaf pages in the index file */
+    unsigned int pages() const { return numPages; }
+
+    /** Returns the number of pages currently cached in memory */
+    size_t cachedPages() const { return pool.cached(); }
+
+    /** Returns the number of page reads served from the cache */
+    unsigned long long cacheHits() const { return pool.cacheHits(); }
+
+    /** Returns the number of pages read from the index file */
+    unsigned long long pageReads() const { return pool.pageReads(); }
+
+  private:
+    /** Returns the size in bytes of an open file, or 0 if unknown */
+    static unsigned long long fileSize(FILE* f) {
+        if (fseeko(f, 0, SEEK_END) != 0) {
+            return 0;
+        }
+        off_t size = ftello(f);
+        return size < 0 ? 0 : size;
+    }
+
+    /** Returns the byte offset of a page in the index file */
+    unsigned long long pageOffset(unsigned int page) const {
+        return ((unsigned long long)page + 1) * pageBytes;
+    }
+
+    /** Returns the byte offset of the node table, right after the pages */
+    unsigned long long nodesOffset() const { return pageOffset(numPages); }
+
+    /** Returns true if a header read from a file of the given size describes
+     *  an index that fits in it, with pages large enough for one point.
+     */
+    static bool headerValid(const Header& header, unsigned long long size) {
+        if (memcmp(header.magic, "DISKKDT1", 8) != 0 || header.numDim == 0 ||
+            header.pageBytes < sizeof(PageHeader) +
+                                   (unsigned long long)header.numDim *
+                                       sizeof(double)) {
+            return false;
+        }
+        if (header.numPoints > 0 ? header.root >= header.numNodes
+                                 : header.root != NONE) {
+            return false;
+        }
+        // an empty index is only its header
+        if (header.numNodes == 0) {
+            return header.numPages == 0;
+        }
+        unsigned long long end =
+            ((unsigned long long)header.numPages + 1) * header.pageBytes +
+            (unsigned long long)header.numNodes * sizeof(DiskNode);
+        return end <= size;
+    }
+
+    /** Returns true if every loaded node links to nodes after it and leaves
+     *  to existing pages, so searches cannot leave the tree or loop.
+     */
+    bool nodesValid() const {
+        for (unsigned int i = 0; i < nodes.size(); i++) {
+            const DiskNode& node = nodes[i];
+            if (node.page != NONE) {
+                if (node.page >= numPages) return false;
+            } else if (node.dim >= numDim || node.left <= i ||
+                       node.left >= nodes.size() || node.right <= i ||
+                       node.right >= nodes.size()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /** Returns the file holding the points of ranges at this build level */
+    FILE* sourceOf(unsigned int level) const {
+        return level == 0 ? input : scratch[(level - 1) % 2];
+    }
+
+    /** Reads or writes count points starting at point number first */
+    bool readRange(FILE* f, unsigned long long first, size_t count,
+                    double* values) {
+        size_t pointBytes = numDim * sizeof(double);
+        ok = ok && seekTo(f, first * pointBytes) &&
+             fread(values, pointBytes, count, f) == count;
+        return ok;
+    }
+    bool writeRange(FILE* f, unsigned long long first, size_t count,
+                     const double* values) {
+        size_t pointBytes = numDim * sizeof(double);
+        ok = ok && seekTo(f, first * pointBytes) &&
+             fwrite(values, pointBytes, count, f) == count;
+        return ok;
+    }
+
+    /** Returns the dimension along which high - low is largest */
+    unsigned int widestDim(const vector<double>& low,
+                           const vector<double>& high) const {
+        unsigned int widest = 0;
+        for (unsigned int d = 1; d < numDim; d++) {
+            if (high[d] - low[d] > high[widest] - low[widest]) widest = d;
+        }
+        return widest;
+    }
+
+    /** Builds the subtree of the points start to end (exclusive) of the
+     *  source file of this level. A range that does not fit in memory is
+     *  split at the median of an evenly spaced sample, moving points below
+     *  the split to the front of the range in the next level's file and
+     *  points above it to the back. Points equal to the split alternate
+     *  between the halves, so neither half is ever empty.
+     *  @param level Depth of the range in the out of core part of the build
+     *  @param height Height of this subtree's root
+     *  @return index of root node of this subtree
+     */
+    unsigned int loadRange(unsigned int level, unsigned long long start,
+                           unsigned long long end, int height) {
+        FILE* source = sourceOf(level);
+        unsigned long long count = end - start;
+        size_t inMemory =
+            max(memoryBudget / (numDim * sizeof(double)), pageCapacity);
+        if (count <= inMemory) {
+            vector<double> values(count * numDim);
+            if (!readRange(source, start, count, values.data())) {
+                return NONE;
+            }
+            vector<unsigned int> order(count);
+            iota(order.begin(), order.end(), 0);
+            return buildInMemory(values, order, 0, count, height);
+        }
+
+        // first pass: bounding box and a sample of the range
+        vector<double> low(numDim, numeric_limits<double>::max());
+        vector<double> high(numDim, numeric_limits<double>::lowest());
+        size_t sampleSize = min<unsigned long long>(SAMPLE_SIZE, count);
+        unsigned long long step = count / sampleSize;
+        vector<double> sample;
+        vector<double> chunk(CHUNK_POINTS * numDim);
+        for (unsigned long long i = start; i < end; i += CHUNK_POINTS) {
+            size_t n = min<unsigned long long>(CHUNK_POINTS, end - i);
+            if (!readRange(source, i, n, chunk.data())) {
+                return NONE;
+            }
+            for (size_t p = 0; p < n; p++) {
+                const double* point = &chunk[p * numDim];
+                for (unsigned int d = 0; d < numDim; d++) {
+                    low[d] = min(low[d], point[d]);
+                    high[d] = max(high[d], point[d]);
+                }
+                if (sample.size() < sampleSize * numDim &&
+                    (i + p - start) % step == 0) {
+                    sample.insert(sample.end(), point, point + numDim);
+                }
+            }
+        }
+        unsigned int dim = widestDim(low, high);
+        vector<double> values;
+        for (size_t s = dim; s < sample.size(); s += numDim) {
+            values.push_back(sample[s]);
+        }
+        nth_element(values.begin(), values.begin() + values.size() / 2,
+                    values.end());
+        double split = values[values.size() / 2];
+
+        // second pass: lower half to the front, upper half to the back
+        FILE* dest = scratch[level % 2];
+        vector<double> lower;
+        vector<double> upper;
+        unsigned long long lowerEnd = start;
+        unsigned long long upperStart = end;
+        unsigned long long ties = 0;
+        for (unsigned long long i = start; i < end; i += CHUNK_POINTS) {
+            size_t n = min<unsigned long long>(CHUNK_POINTS, end - i);
+            if (!readRange(source, i, n, chunk.data())) {
+                return NONE;
+            }
+            for (size_t p = 0; p < n; p++) {
+                const double* point = &chunk[p * numDim];
+                bool goLower = point[dim] < split ||
+                               (point[dim] == split && ties++ % 2 == 1);
+                vector<double>& half = goLower ? lower : upper;
+                half.insert(half.end(), point, point + numDim);
+            }
+            writeRange(dest, lowerEnd, lower.size() / numDim, lower.data());
+            lowerEnd += lower.size() / numDim;
+            upperStart -= upper.size() / numDim;
+            writeRange(dest, upperStart, upper.size() / numDim,
+                        upper.data());
+            lower.clear();
+            upper.clear();
+        }
+        if (!ok) {
+            return NONE;
+        }
+
+        unsigned int current = nodes.size();
+        nodes.push_back(DiskNode{split, dim, NONE, NONE, NONE});
+        unsigned int left = loadRange(level + 1, start, lowerEnd, height + 1);
+        unsigned int right = loadRange(level + 1, lowerEnd, end, height + 1);
+        nodes[current].left = left;
+        nodes[current].right = right;
+        return current;
+    }
+
+    /** Builds the subtree of points order[start] to order[end - 1] in
+     *  memory, splitting at the median of the widest dimension until a range
+     *  fits on one page.
+     *  @param values Features of the points, numDim per point
+     *  @param height Height of this subtree's root
+     *  @return index of root node of this subtree
+     */
+    unsigned int buildInMemory(const vector<double>& values,
+                               vector<unsigned int>& order, size_t start,
+                               size_t end, int height) {
+        if (end - start <= pageCapacity) {
+            return writeLeaf(values, order, start, end, height);
+        }
+        vector<double> low(numDim, numeric_limits<double>::max());
+        vector<double> high(numDim, numeric_limits<double>::lowest());
+        for (size_t i = start; i < end; i++) {
+            const double* point = &values[order[i] * numDim];
+            for (unsigned int d = 0; d < numDim; d++) {
+                low[d] = min(low[d], point[d]);
+                high[d] = max(high[d], point[d]);
+            }
+        }
+        unsigned int dim = widestDim(low, high);
+        size_t mid = start + (end - start) / 2;
+        nth_element(order.begin() + start, order.begin() + mid,
+                    order.begin() + end,
+                    [&](unsigned int a, unsigned int b) {
+                        return values[a * numDim + dim] <
+                               values[b * numDim + dim];
+                    });
+        double split = values[order[mid] * numDim + dim];
+
+        unsigned int current = nodes.size();
+        nodes.push_back(DiskNode{split, dim, NONE, NONE, NONE});
+        unsigned int left =
+            buildInMemory(values, order, start, mid, height + 1);
+        unsigned int right = buildInMemory(values, order, mid, end, height + 1);
+        nodes[current].left = left;
+        nodes[current].right = right;
+        return current;
+    }
+
+    /** Writes points order[start] to order[end - 1] as the next page
+     *  @return index of the new leaf node
+     */
+    unsigned int writeLeaf(const vector<double>& values,
+                           const vector<unsigned int>& order, size_t start,
+                           size_t end, int height) {
+        PageHeader header = {(unsigned int)(end - start), 0};
+        memcpy(pageBuffer.data(), &header, sizeof(header));
+        double* page = (double*)(pageBuffer.data() + sizeof(PageHeader));
+        for (size_t i = start; i < end; i++) {
+            memcpy(page + (i - start) * numDim, &values[order[i] * numDim],
+                   numDim * sizeof(double));
+        }
+        ok = ok && seekTo(out, pageOffset(numPages)) &&
+             fwrite(pageBuffer.data(), 1, pageBytes, out) == pageBytes;
+
+        if (height > iheight) {
+            iheight = height;
+        }
+        nodes.push_back(DiskNode{0, 0, NONE, NONE, numPages});
+        numPages++;
+        return nodes.size() - 1;
+    }
+
+    /** Returns the point count of a fetched page and its features. A page
+     *  claiming more points than fit in it is corrupt and counts as empty,
+     *  like a page that cannot be read.
+     */
+    unsigned int pointsOf(const char* page, const double*& features) const {
+        PageHeader header;
+        memcpy(&header, page, sizeof(header));
+        features = (const double*)(page + sizeof(PageHeader));
+        return header.count <= pageCapacity ? header.count : 0;
+    }
+
+    /** Helper method to recursively find the nearest neighbor of query
+     *  point. A leaf's page is only read if the splitting planes above it
+     *  are closer than the nearest point found so far.
+     *  @param index Index of the current node being checked
+     *  @param query Features of the query point
+     */
+    void findNNHelper(unsigned int index, const double* query) {
+        const DiskNode& node = nodes[index];
+        if (node.page != NONE) {
+            const char* page = pool.fetch(node.page);
+            if (page == nullptr) {
+                return;
+            }
+            const double* features;
+            unsigned int count = pointsOf(page, features);
+            for (unsigned int i = 0; i < count; i++) {
+                const double* point = features + i * numDim;
+                double dist = metric(point, query, numDim);
+                if (dist < threshold) {
+                    threshold = dist;
+                    nearestNeighbor =
+                        Point(vector<double>(point, point + numDim));
+                }
+            }
+            return;
+        }
+
+        // if query larger than or equal to split, go right first
+        double diff = query[node.dim] - node.split;
+        findNNHelper(diff >= 0 ? node.right : node.left, query);
+        if (metric.axis(diff, node.dim) < threshold) {
+            findNNHelper(diff >= 0 ? node.left : node.right, query);
+        }
+    }
+
+    /** Helper method to find all points inside the query region.
+     *  @param index Index of current node being checked
+     *  @param queryRegion Query region to perform range search
+     *  @param result Container that points inside the region are added to
+     */
+    void rangeSearchHelper(unsigned int index,
+                           vector<pair<double, double>>& queryRegion,
+                           vector<Point>& result) {
+        const DiskNode& node = nodes[index];
+        if (node.page != NONE) {
+            const char* page = pool.fetch(node.page);
+            if (page == nullptr) {
+                return;
+            }
+            const double* features;
+            unsigned int count = pointsOf(page, features);
+            for (unsigned int i = 0; i < count; i++) {
+                const double* point = features + i * numDim;
+                bool inside = true;
+                for (unsigned int d = 0; d < numDim && inside; d++) {
+                    inside = point[d] >= queryRegion[d].first &&
+                             point[d] <= queryRegion[d].second;
+                }
+                if (inside) {
+                    result.push_back(
+                        Point(vector<double>(point, point + numDim)));
+                }
+            }
+            return;
+        }
+        if (queryRegion[node.dim].first <= node.split) {
+            rangeSearchHelper(node.left, queryRegion, result);
+        }
+        if (queryRegion[node.dim].second >= node.split) {
+            rangeSearchHelper(node.right, queryRegion, result);
+        }
+    }
+};
+
+/** Disk KD tree using squared Euclidean distance */
+typedef BasicDiskKDT<SquaredEuclidean> DiskKDT;
+
+#endif /* DiskKDT_hpp */
@@ -0,0 +1,290 @@
+/**
+ * Uniform grid index over Points.
+ *
+ * The bounding box of the points is cut into equally many cells along each
+ * dimension, with about POINTS_PER_CELL points per cell on average. Points
+ * are stored sorted by cell, so each cell is one contiguous run. For dense,
+ * low dimensional data this answers queries by looking at a few cells
+ * around the query instead of descending a tree.
+ */
+
+#ifndef GridIndex_hpp
+#define GridIndex_hpp
+
+#include <math.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include "Metric.hpp"
+#include "Point.hpp"
+
+using namespace std;
+
+template <class Metric = SquaredEuclidean>
+class BasicGridIndex {
+  private:
+    // average number of points per cell the grid is sized for
+    enum { POINTS_PER_CELL = 2 };
+
+    // the points, sorted by the cell they fall in
+    vector<Point> points;
+
+    // points of cell c are points[cellStart[c]] to points[cellStart[c + 1]]
+    vector<unsigned int> cellStart;
+
+    // smallest box containing all points
+    vector<pair<double, double>> box;
+
+    // per dimension: number of cells, width of a cell and index stride
+    vector<int> cellsPerDim;
+    vector<double> cellWidth;
+    vector<size_t> stride;
+
+    unsigned int numDim;
+
+    // distance metric used for searching
+    Metric metric;
+
+  public:
+    /** Constructor of an empty grid index
+     *  @param metric Distance metric used for nearest neighbor search
+     */
+    BasicGridIndex(const Metric& metric = Metric())
+        : numDim(0), metric(metric) {}
+
+    /** Sizes the grid from the bounding box of the points and buckets every
+     *  point into its cell.
+     *  @param points Vector of points to put into the grid
+     */
+    void build(vector<Point>& points) {
+        this->points.clear();
+        cellStart.clear();
+        box = boundingBoxOf(points);
+        if (points.empty()) {
+            return;
+        }
+        numDim = points[0].numDim;
+
+        // equally many cells per dimension, except along flat dimensions
+        unsigned int spreadDims = 0;
+        for (unsigned int d = 0; d < numDim; d++) {
+            if (box[d].second > box[d].first) spreadDims++;
+        }
+        double targetCells = (double)points.size() / POINTS_PER_CELL;
+        int cells = spreadDims == 0
+                        ? 1
+                        : (int)pow(targetCells, 1.0 / spreadDims);
+        if (cells < 1) cells = 1;
+
+        cellsPerDim.assign(numDim, 1);
+        cellWidth.assign(numDim, 1);
+        stride.assign(numDim, 1);
+        size_t numCells = 1;
+        for (unsigned int d = 0; d < numDim; d++) {
+            double extent = box[d].second - box[d].first;
+            if (extent > 0) {
+                cellsPerDim[d] = cells;
+                cellWidth[d] = extent / cells;
+            }
+            stride[d] = numCells;
+            numCells *= cellsPerDim[d];
+        }
+
+        // counting sort of the points by cell
+        vector<size_t> cellOfPoint(points.size());
+        cellStart.assign(numCells + 1, 0);
+        for (size_t i = 0; i < points.size(); i++) {
+            size_t cell = 0;
+            for (unsigned int d = 0; d < numDim; d++) {
+                cell += cellCoord(points[i].features[d], d) * stride[d];
+            }
+            cellOfPoint[i] = cell;
+            cellStart[cell + 1]++;
+        }
+        for (size_t c = 0; c < numCells; c++) {
+            cellStart[c + 1] += cellStart[c];
+        }
+        vector<unsigned int> next(cellStart.begin(), cellStart.end() - 1);
+        this->points.resize(points.size());
+        for (size_t i = 0; i < points.size(); i++) {
+            this->points[next[cellOfPoint[i]]++] = points[i];
+        }
+    }
+
+    /** Returns a pointer to the nearest neighbor of the query point, or
+     *  nullptr if the grid is empty. Cells are searched in rings of growing
+     *  size around the query's cell until no unvisited cell can hold a closer
+     *  point.
+     *  @param queryPoint Query point to find the nearest neighbor of
+     */
+    Point* findNearestNeighbor(Point& queryPoint) {
+        if (points.empty()) {
+            return nullptr;
+        }
+        const double* query = queryPoint.features.data();
+        vector<int> center(numDim);
+        int maxRing = 0;
+        for (unsigned int d = 0; d < numDim; d++) {
+            center[d] = cellCoord(query[d], d);
+            maxRing = max(maxRing, center[d]);
+            maxRing = max(maxRing, cellsPerDim[d] - 1 - center[d]);
+        }
+
+        double bestDist = numeric_limits<double>::max();
+        unsigned int best = 0;
+        vector<int> low(numDim);
+        vector<int> high(numDim);
+        for (int ring = 0; ring <= maxRing; ring++) {
+            for (unsigned int d = 0; d < numDim; d++) {
+                low[d] = max(center[d] - ring, 0);
+                high[d] = min(center[d] + ring, cellsPerDim[d] - 1);
+            }
+            forEachCell(low, high, [&](const vector<int>& cell, size_t index) {
+                if (!onRing(cell, center, ring)) return;
+                for (unsigned int i = cellStart[index];
+                     i < cellStart[index + 1]; i++) {
+                    double dist =
+                        metric(points[i].features.data(), query, numDim);
+                    if (dist < bestDist) {
+                        bestDist = dist;
+                        best = i;
+                    }
+                }
+            });
+
+            // any point outside the searched block is at least as far as
+            // the block's nearest inner side from the query
+            if (bestDist <= exitDistance(query, center, ring)) {
+                break;
+            }
+        }
+
+        Point& nearest = points[best];
+        nearest.distToQuery = bestDist;
+        return &nearest;
+    }
+
+    /** Returns all points inside the query region, grouped by cell.
+     *  @param queryRegion The query region to perform region search
+     */
+    vector<Point> rangeSearch(vector<pair<double, double>>& queryRegion) {
+        vector<Point> result;
+        if (points.empty()) {
+            return result;
+        }
+        vector<int> low(numDim);
+        vector<int> high(numDim);
+        for (unsigned int d = 0; d < numDim; d++) {
+            if (queryRegion[d].first > queryRegion[d].second ||
+                queryRegion[d].first > box[d].second ||
+                queryRegion[d].second < box[d].first) {
+                return result;
+            }
+            low[d] = cellCoord(queryRegion[d].first, d);
+            high[d] = cellCoord(queryRegion[d].second, d);
+        }
+        forEachCell(low, high, [&](const vector<int>&, size_t index) {
+            for (unsigned int i = cellStart[index]; i < cellStart[index + 1];
+                 i++) {
+                if (inRegion(points[i], queryRegion)) {
+                    result.push_back(points[i]);
+                }
+            }
+        });
+        return result;
+    }
+
+    /** Returns the number of points in the grid */
+    unsigned int size() const { return points.size(); }
+
+    /** Returns the number of cells in the grid */
+    size_t numCells() const {
+        return cellStart.empty() ? 0 : cellStart.size() - 1;
+    }
+
+  private:
+    /** Returns the cell coordinate of value along dimension d, clamped to
+     *  the grid so values outside the bounding box map to a border cell.
+     */
+    int cellCoord(double value, unsigned int d) const {
+        double offset = (value - box[d].first) / cellWidth[d];
+        if (!(offset > 0)) return 0;
+        if (offset >= cellsPerDim[d]) return cellsPerDim[d] - 1;
+        return (int)offset;
+    }
+
+    /** Calls visit(cell coordinates, cell index) for every cell between low
+     *  and high (inclusive) in each dimension.
+     */
+    template <class Visit>
+    void forEachCell(const vector<int>& low, const vector<int>& high,
+                     Visit visit) const {
+        vector<int> cell = low;
+        size_t index = 0;
+        for (unsigned int d = 0; d < numDim; d++) {
+            index += cell[d] * stride[d];
+        }
+        while (true) {
+            visit(cell, index);
+            unsigned int d = 0;
+            while (d < numDim && cell[d] == high[d]) {
+                index -= (size_t)(cell[d] - low[d]) * stride[d];
+                cell[d] = low[d];
+                d++;
+            }
+            if (d == numDim) return;
+            cell[d]++;
+            index += stride[d];
+        }
+    }
+
+    /** Returns true if cell is exactly ring cells away from center along
+     *  some dimension, i.e. it was not visited by a smaller ring.
+     */
+    bool onRing(const vector<int>& cell, const vector<int>& center,
+                int ring) const {
+        for (unsigned int d = 0; d < numDim; d++) {
+            if (abs(cell[d] - center[d]) == ring) return true;
+        }
+        return ring == 0;
+    }
+
+    /** Returns a lower bound on the distance from the query to any point in
+     *  a cell more than ring cells from center. Sides of the block on the
+     *  border of the grid have no cells beyond them.
+     */
+    double exitDistance(const double* query, const vector<int>& center,
+                        int ring) const {
+        double bound = numeric_limits<double>::max();
+        for (unsigned int d = 0; d < numDim; d++) {
+            if (center[d] - ring > 0) {
+                double side = box[d].first + (center[d] - ring) * cellWidth[d];
+                bound = min(bound, metric.axis(max(query[d] - side, 0.0), d));
+            }
+            if (center[d] + ring < cellsPerDim[d] - 1) {
+                double side =
+                    box[d].first + (center[d] + ring + 1) * cellWidth[d];
+                bound = min(bound, metric.axis(max(side - query[d], 0.0), d));
+            }
+        }
+        return bound;
+    }
+
+    /** Returns true if point lies inside the query region */
+    bool inRegion(const Point& point,
+                  vector<pair<double, double>>& queryRegion) const {
+        for (unsigned int d = 0; d < numDim; d++) {
+            if (point.features[d] < queryRegion[d].first ||
+                point.features[d] > queryRegion[d].second) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+/** Grid index using squared Euclidean distance */
+typedef BasicGridIndex<SquaredEuclidean> GridIndex;
+
+#endif /* GridIndex_hpp */
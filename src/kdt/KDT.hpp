@@ -3,33 +3,89 @@
 
 #include <math.h>     // pow, abs
 #include <algorithm>  // sort, max, min
+#include <chrono>     // steady_clock
+#include <future>     // async, future
+#include <iterator>   // make_move_iterator
 #include <limits>     // numeric_limits<type>::max()
+#include <thread>     // thread::hardware_concurrency
 #include <vector>     // vector<typename>
+#include "Metric.hpp"
 #include "Point.hpp"
+#include "SearchStats.hpp"
+#include "SplitRule.hpp"
 
 using namespace std;
 
-class KDT {
+// hint that address will be read soon; a no-op where unsupported
+#if defined(__GNUC__)
+#define KDT_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define KDT_PREFETCH(address)
+#endif
+
+/** Limits on the work of one budgeted nearest neighbor search. The search
+ *  stops at whichever limit it reaches first; by default there is none.
+ */
+struct SearchBudget {
+    // most nodes the search may visit
+    unsigned long long maxNodes = numeric_limits<unsigned long long>::max();
+
+    // time at which the search stops
+    chrono::steady_clock::time_point deadline =
+        chrono::steady_clock::time_point::max();
+};
+
+/** KD tree over Points. The distance used for nearest neighbor search is
+ *  given by the Metric policy (see Metric.hpp); KDT is the squared Euclidean
+ *  instantiation.
+ */
+template <class Metric = SquaredEuclidean>
+class BasicKDT {
   private:
-    /** Inner class which defines a KD tree node */
+    // index used in place of a child or root that does not exist
+    enum : unsigned int { NONE = 0xFFFFFFFFu };
+
+    // set on a child or root index that refers to an entry of lazyRanges,
+    // i.e. a subtree whose points have not been partitioned yet
+    enum : unsigned int { LAZY = 0x80000000u };
+
+    /** Inner class which defines a KD tree node. Nodes live in one
+     *  contiguous vector and refer to their children by index; the features
+     *  of each node's point are kept in coords, not in the node.
+     */
     class KDNode {
       public:
-        KDNode* left;
-        KDNode* right;
-        Point point;
+        unsigned int left;
+        unsigned int right;
+        unsigned int dim;  // split dimension of this node
 
-        KDNode(Point point) : point(point) {}
+        KDNode(unsigned int dim) : left(NONE), right(NONE), dim(dim) {}
     };
 
-    // root of KD tree
-    KDNode* root;
+    // every node of the KD tree, allocated together in one block
+    vector<KDNode> nodes;
+
+    // features of the point of node i at coords[i * numDim], in one block
+    vector<double> coords;
+
+    // index of root of KD tree
+    unsigned int root;
 
     // number of dimension of data points
     unsigned int numDim;
 
-    // smallest squared distance to query point so far
+    // distance metric used for searching
+    Metric metric;
+
+    // rule used to choose each node's split dimension and split point
+    SplitRule splitRule;
+
+    // smallest distance (in metric's comparable form) to query point so far
     double threshold;
 
+    // index of the node closest to the query point so far
+    unsigned int nearestIndex;
+
     unsigned int isize;
     int iheight;
 
@@ -43,19 +99,142 @@ class KDT {
     // (Set during searching, and clear before another search)
     vector<Point> pointsInRange;
 
+    // work done by the last search (only counted when KDT_STATS is defined)
+    SearchStats stats;
+
+    /** Points of a subtree that has not been built yet */
+    struct LazyRange {
+        unsigned int start;      // inclusive start index into lazyPoints
+        unsigned int end;        // exclusive end index into lazyPoints
+        unsigned int parentDim;  // split dimension of the parent node
+        int height;              // height of the subtree's root node
+    };
+
+    // if true, build only copies the points and each subtree is built when
+    // a search first descends into it
+    bool lazy;
+
+    // settings the current tree was built with, which the setters above do
+    // not change until the next build; subtrees still to be expanded are
+    // built with them too
+    bool builtLazily;
+    SplitRule builtSplitRule;
+    bool builtCellBounds;
+
+    // copy of the built points, partitioned as subtrees are built lazily
+    vector<Point> lazyPoints;
+
+    // subtrees waiting to be built, referred to by LAZY child indices
+    vector<LazyRange> lazyRanges;
+
+    // if true, every node stores the bounding box of its subtree's points
+    bool useCellBounds;
+
+    // if true, build stores one node per distinct location
+    bool collapse;
+
+    // the distinct locations of a collapsed build in lexicographic order,
+    // numDim features each
+    vector<double> groupKeys;
+
+    // ids (indices in the input of build) of the points at distinct location
+    // g are groupIds[groupStart[g]] to groupIds[groupStart[g + 1]]
+    vector<unsigned int> groupStart;
+    vector<unsigned int> groupIds;
+
+    // bounding box of the points in the subtree of node i, stored as
+    // (lower, upper) floats at cellBounds[(i * numDim + d) * 2], rounded
+    // outwards so the box still contains every point
+    vector<float> cellBounds;
+
+    // a budgeted search reads the clock once per this many nodes
+    enum { CLOCK_CHECK_NODES = 16 };
+
+    // step of a node reached by a batched nearest neighbor search
+    enum NNPhase : unsigned int { ARRIVE, DESCEND, FAR_SIDE, VISIT };
+
+    /** One node on the explicit stack of a batched search */
+    struct NNFrame {
+        unsigned int index;
+        NNPhase phase;
+    };
+
+    /** State of one query in a batched nearest neighbor search, i.e. the
+     *  recursion of findNNHelper turned into an explicit stack.
+     */
+    struct NNQuery {
+        const Point* query;
+        unsigned int resultIndex;  // position of the query in the batch
+        double threshold;          // smallest distance so far
+        unsigned int best;         // index of the nearest node so far
+        unsigned long long visited;  // number of nodes pushed so far
+        vector<NNFrame> stack;
+    };
+
   public:
-    /** Constructor of KD tree */
-    KDT()
-        : root(0),
+    /** Constructor of KD tree
+     *  @param metric Distance metric used for nearest neighbor search
+     */
+    BasicKDT(const Metric& metric = Metric())
+        : root(NONE),
           numDim(0),
+          metric(metric),
+          splitRule(CYCLE),
           threshold(numeric_limits<double>::max()),
+          nearestIndex(NONE),
           isize(0),
-          iheight(-1) {}
+          iheight(-1),
+          lazy(false),
+          builtLazily(false),
+          builtSplitRule(CYCLE),
+          builtCellBounds(false),
+          useCellBounds(true),
+          collapse(false) {}
+
+    /** Destructor of KD tree. All nodes are released with their vector. */
+    virtual ~BasicKDT() {}
+
+    /** Sets the rule used to split nodes in later calls to build. The default
+     *  CYCLE rule builds the classic balanced KD tree.
+     *  @param rule Split rule to use
+     */
+    void setSplitRule(SplitRule rule) { splitRule = rule; }
+
+    /** Sets whether later calls to build construct the tree lazily. A lazy
+     *  build only copies the points in O(n); each subtree is partitioned the
+     *  first time a search descends into it, so regions no query touches are
+     *  never sorted, and with the CYCLE and MAX_SPREAD rules a subtree is
+     *  partitioned around its median in linear time. Searches find the same
+     *  points as with a full build, though range search may list points that
+     *  tie on a split value in another order. Parallel range search runs
+     *  serially on a lazily built tree.
+     *  @param lazyBuild True to build lazily
+     */
+    void setLazyBuild(bool lazyBuild) { lazy = lazyBuild; }
 
-    /** Destructor of KD tree */
-    virtual ~KDT() { deleteAll(root); }
+    /** Sets whether later calls to build store the bounding box of each
+     *  node's subtree, which is on by default. Searches then skip subtrees
+     *  by the extent of their points instead of the splitting planes, which
+     *  prunes far more on clustered data, at the cost of 8 bytes per node
+     *  per dimension. Range search also reports subtrees that lie inside
+     *  the region without checking their points.
+     *  @param cellBounds True to store node bounding boxes
+     */
+    void setCellBounds(bool cellBounds) { useCellBounds = cellBounds; }
 
-    /** Builds a balanced KD tree with points as input.
+    /** Sets whether later calls to build collapse duplicate points, which is
+     *  off by default. Points equal under Point::operator== that are next to
+     *  each other in lexicographic order (always the case for exact
+     *  duplicates) then share one node, and size and height count distinct
+     *  locations. The ids of the input points at each location are kept, so
+     *  findNearestNeighborIds and rangeSearchIds can still report every one.
+     *  @param collapseDuplicates True to collapse duplicate points
+     */
+    void setCollapseDuplicates(bool collapseDuplicates) {
+        collapse = collapseDuplicates;
+    }
+
+    /** Builds a KD tree with points as input, split by the split rule.
      *  @param points Vector of points to put into the KD tree.
      */
     void build(vector<Point>& points) {
@@ -63,41 +242,62 @@ class KDT {
         if (points.empty() || points.size() == 0) {
             return;
         }
-        // Set numDim based on first point
-        numDim = points[0].numDim;
-
-        // sort points based on dim[0]
-        std::sort(points.begin(), points.end(), CompareValueAt(0));
-
-        // set median as root
-        int start = 0;
-        int end = points.size();
-        int medianIndex = floor((start + end) / 2);
-        root = new KDNode(points[medianIndex]);
+        groupKeys.clear();
+        groupStart.clear();
+        groupIds.clear();
+        if (collapse) {
+            vector<Point> distinct = collapseDuplicates(points);
+            buildTree(distinct);
+        } else {
+            buildTree(points);
+        }
+    }
 
-        // increase tracking variables
-        isize += 1;
-        unsigned int height = 0;
-        iheight = height;
+    /** Returns the ids of every input point at the location of the nearest
+     *  neighbor of the query point. An id is the index of the point in the
+     *  vector given to build. Only a tree built with collapsed duplicates has
+     *  ids; otherwise the result is empty.
+     *  @param queryPoint Query point to find the nearest neighbor of
+     */
+    vector<unsigned int> findNearestNeighborIds(Point& queryPoint) {
+        vector<unsigned int> ids;
+        if (groupStart.empty()) {
+            return ids;
+        }
+        appendIds(*findNearestNeighbor(queryPoint), ids);
+        return ids;
+    }
 
-        // recursively build sub trees
-        root->left =
-            buildSubtree(points, start, medianIndex, 1 % numDim, height);
-        root->right =
-            buildSubtree(points, medianIndex + 1, end, 1 % numDim, height);
+    /** Returns the ids of every input point inside the query region. Only a
+     *  tree built with collapsed duplicates has ids; otherwise the result is
+     *  empty.
+     *  @param queryRegion The query region to perform region search
+     */
+    vector<unsigned int> rangeSearchIds(
+        vector<pair<double, double>>& queryRegion) {
+        vector<unsigned int> ids;
+        if (groupStart.empty()) {
+            return ids;
+        }
+        for (const Point& point : rangeSearch(queryRegion)) {
+            appendIds(point, ids);
+        }
+        return ids;
+    }
 
-        // extra credit - bounding box not used however.
-        // set boundingBox as smallest box containing all points
-        for (unsigned int i = 0; i < numDim; i++) {
-            double lowerBound = numeric_limits<double>::max();
-            double upperBound = numeric_limits<double>::min();
-            for (Point p : points) {
-                if (p.valueAt(i) < lowerBound) lowerBound = p.valueAt(i);
-                if (p.valueAt(i) > upperBound) upperBound = p.valueAt(i);
-            }
-            // add boundary pair to boundingBox
-            boundingBox.emplace_back(make_pair(lowerBound, upperBound));
+    /** Returns how many input points a point returned by a search of a
+     *  collapsed tree stands for. Always 1 if duplicates were not collapsed.
+     *  @param point Point returned by a search of this tree
+     */
+    unsigned int multiplicity(const Point& point) const {
+        if (groupStart.empty()) {
+            return 1;
         }
+        unsigned int group = groupOfPoint(point);
+        if (group == groupStart.size()) {
+            return 0;
+        }
+        return groupStart[group + 1] - groupStart[group];
     }
 
     /** Returns a pointer to the nearest neighbor of a given query point in the
@@ -113,10 +313,114 @@ class KDT {
         }
 
         threshold = numeric_limits<double>::max();  // reset threshold
+        KDT_STAT(stats.reset());
 
         // call helper function to find nearest neighbor and set threshold
-        findNNHelper(root, queryPoint, 0);
+        findNNHelper(expand(root), queryPoint);
+
+        nearestNeighbor = pointOf(nearestIndex);
+        nearestNeighbor.distToQuery = threshold;
+        return &nearestNeighbor;
+    }
+
+    /** Finds the nearest neighbor of every query point, running groupSize
+     *  queries at once. Each query is a resumable search that prefetches the
+     *  next node it needs and then yields to the other queries, so the
+     *  memory latency of one query overlaps with work on the others. This
+     *  raises throughput on trees much larger than the cache. Search
+     *  statistics are not collected.
+     *  @param queryPoints Query points to find the nearest neighbors of
+     *  @param groupSize Number of queries interleaved at once
+     *  @return Copy of the nearest neighbor of each query point, in order,
+     *          with distToQuery set. Empty if the tree is empty.
+     */
+    vector<Point> findNearestNeighbors(vector<Point>& queryPoints,
+                                       unsigned int groupSize = 16) {
+        vector<Point> result;
+        if (isize == 0 || queryPoints.empty()) {
+            return result;
+        }
+        result.resize(queryPoints.size());
+        expand(root);
+
+        if (groupSize == 0) groupSize = 1;
+        vector<NNQuery> group(min<size_t>(groupSize, queryPoints.size()));
+        unsigned int next = 0;
+        for (NNQuery& state : group) {
+            startQuery(state, queryPoints[next], next);
+            next++;
+        }
+
+        // round robin over the group until every query is answered
+        unsigned int active = group.size();
+        while (active > 0) {
+            for (NNQuery& state : group) {
+                if (state.query == nullptr || !stepQuery(state)) {
+                    continue;
+                }
+                Point& nearest = result[state.resultIndex];
+                nearest = pointOf(state.best);
+                nearest.distToQuery = state.threshold;
+                if (next < queryPoints.size()) {
+                    startQuery(state, queryPoints[next], next);
+                    next++;
+                } else {
+                    state.query = nullptr;
+                    active--;
+                }
+            }
+        }
+        return result;
+    }
+
+    /** Returns a pointer to the best nearest neighbor candidate of the query
+     *  point found within the budget, or nullptr if the KD tree is empty.
+     *  Nodes are searched in the same order as findNearestNeighbor. When the
+     *  budget runs out, the nodes on the current search path are checked as
+     *  well, so the search visits at most budget.maxNodes plus the height of
+     *  the tree. Search statistics are not collected.
+     *  @param queryPoint Query point to find the nearest neighbor of
+     *  @param budget Node and time limits of the search
+     *  @param exact Set to true if the search finished, so the result is
+     *               proven to be the nearest neighbor
+     *  @return Pointer to the nearest neighbor found so far
+     */
+    Point* findNearestNeighbor(Point& queryPoint, const SearchBudget& budget,
+                               bool& exact) {
+        exact = true;
+        if (isize == 0) {
+            return nullptr;
+        }
+        expand(root);
 
+        NNQuery state;
+        startQuery(state, queryPoint, 0);
+        bool timed =
+            budget.deadline != chrono::steady_clock::time_point::max();
+        unsigned long long nextClockCheck = 0;
+        while (!stepQuery(state)) {
+            if (state.visited > budget.maxNodes) {
+                exact = false;
+            } else if (timed && state.visited >= nextClockCheck) {
+                nextClockCheck = state.visited + CLOCK_CHECK_NODES;
+                exact = chrono::steady_clock::now() < budget.deadline;
+            }
+            if (!exact) {
+                break;
+            }
+        }
+
+        // out of budget: the nodes on the path are next in line anyway
+        for (NNFrame& frame : state.stack) {
+            double dist = metric(coordsOf(frame.index),
+                                 queryPoint.features.data(), numDim);
+            if (dist < state.threshold) {
+                state.threshold = dist;
+                state.best = frame.index;
+            }
+        }
+        nearestNeighbor = pointOf(state.best);
+        nearestNeighbor.distToQuery = state.threshold;
         return &nearestNeighbor;
     }
 
@@ -128,11 +432,48 @@ class KDT {
     vector<Point> rangeSearch(vector<pair<double, double>>& queryRegion) {
         // reset pointsInRange before new search
         pointsInRange = {};
+        KDT_STAT(stats.reset());
         // call helper function
-        rangeSearchHelper(root, boundingBox, queryRegion, 0);
+        rangeSearchHelper(expand(root), boundingBox, queryRegion,
+                          pointsInRange, stats);
         return pointsInRange;
     }
 
+    /** Returns a vector containing all points inside query region, searching
+     *  disjoint subtrees on multiple threads. Results are in the same order
+     *  as rangeSearch.
+     *  @param queryRegion The query region to perform region search
+     *  @param numThreads Number of threads to split the search over
+     *  @return Vector of all points inside query region
+     */
+    vector<Point> parallelRangeSearch(
+        vector<pair<double, double>>& queryRegion,
+        unsigned int numThreads = thread::hardware_concurrency()) {
+        // fork while there are fewer tasks than twice the threads, so a
+        // subtree with few matches does not leave a thread idle
+        int forkDepth = 0;
+        while ((1u << forkDepth) < 2 * numThreads && forkDepth < 16) {
+            forkDepth++;
+        }
+        // lazily built subtrees cannot be built from several threads at once
+        if (numThreads <= 1 || builtLazily) {
+            forkDepth = 0;
+        }
+
+        vector<Point> result;
+        KDT_STAT(stats.reset());
+        parallelRangeHelper(expand(root), queryRegion, result, forkDepth,
+                            stats);
+        return result;
+    }
+
+    /** Returns the work done by the last nearest neighbor or range search.
+     *  Counters are only collected when compiled with KDT_STATS defined and
+     *  are all zero otherwise.
+     *  @return Statistics of the last search
+     */
+    const SearchStats& lastSearchStats() const { return stats; }
+
     /** Returns the size of the KDT. This is the number of items in the tree.
      *  @return Size of KDT
      */
@@ -140,33 +481,160 @@ class KDT {
 
     /** Returns the height of the KDT. This is how many levels the tree has.
      *  Note that empty KDT has height -1 and KDT with one node has height 0.
+     *  After a lazy build with the SLIDING_MIDPOINT or SURFACE_AREA rule, only
+     *  subtrees that have been built so far are counted.
      *  @return Height of KDT
      */
     int height() const { return iheight; }
 
+    /** Returns the smallest box containing every point of the last build, as
+     *  a (lower, upper) pair for each dimension.
+     */
+    const vector<pair<double, double>>& getBoundingBox() const {
+        return boundingBox;
+    }
+
   private:
+    /** Builds the KD tree from non-empty points, replacing any old tree */
+    void buildTree(vector<Point>& points) {
+        // Set numDim based on first point
+        numDim = points[0].numDim;
+
+        // discard any previous tree and allocate every node up front
+        nodes.clear();
+        nodes.reserve(points.size());
+        coords.clear();
+        coords.reserve((size_t)points.size() * numDim);
+        isize = 0;
+        iheight = -1;
+
+        lazyPoints.clear();
+        lazyRanges.clear();
+        cellBounds.clear();
+        builtLazily = lazy;
+        builtSplitRule = splitRule;
+        builtCellBounds = useCellBounds;
+        if (useCellBounds) {
+            cellBounds.reserve((size_t)points.size() * numDim * 2);
+        }
+
+        // build from root, whose parent dimension is numDim - 1 so that the
+        // CYCLE rule splits the root on dimension 0
+        if (lazy) {
+            // nodes was reserved for every point above, so building more
+            // nodes during a search never moves the nodes being searched
+            lazyPoints = points;
+            root = lazyLink(0, points.size(), numDim - 1, 0);
+            isize = points.size();
+            iheight = lazyHeight(points.size());
+        } else {
+            root = buildSubtree(points, 0, points.size(), numDim - 1, -1);
+            if (useCellBounds) {
+                computeCellBounds();
+            }
+        }
+
+        // set boundingBox as smallest box containing all points
+        boundingBox = boundingBoxOf(points);
+    }
+
+    /** Groups duplicate points and records the ids at each distinct
+     *  location in groupKeys, groupStart and groupIds.
+     *  @return One point per distinct location
+     */
+    vector<Point> collapseDuplicates(const vector<Point>& points) {
+        vector<unsigned int> order(points.size());
+        for (unsigned int i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b) {
+            return points[a].features < points[b].features;
+        });
+
+        // each point joins the group of the last distinct location if it
+        // equals that location's first point
+        vector<Point> distinct;
+        vector<unsigned int> groupOf(points.size());
+        for (unsigned int i : order) {
+            if (distinct.empty() || distinct.back() != points[i]) {
+                distinct.push_back(points[i]);
+                groupKeys.insert(groupKeys.end(), points[i].features.begin(),
+                                 points[i].features.end());
+            }
+            groupOf[i] = distinct.size() - 1;
+        }
+
+        // counting sort of ids by group, in increasing id order per group
+        groupStart.assign(distinct.size() + 1, 0);
+        for (unsigned int i = 0; i < points.size(); i++) {
+            groupStart[groupOf[i] + 1]++;
+        }
+        for (unsigned int g = 0; g < distinct.size(); g++) {
+            groupStart[g + 1] += groupStart[g];
+        }
+        groupIds.resize(points.size());
+        vector<unsigned int> next(groupStart.begin(), groupStart.end() - 1);
+        for (unsigned int i = 0; i < points.size(); i++) {
+            groupIds[next[groupOf[i]]++] = i;
+        }
+        return distinct;
+    }
+
+    /** Returns the group of a distinct location returned by a search of a
+     *  collapsed tree, or groupStart.size() if there is none.
+     */
+    unsigned int groupOfPoint(const Point& point) const {
+        const double* key = point.features.data();
+        unsigned int low = 0;
+        unsigned int high = groupStart.size() - 1;
+        while (low < high) {
+            unsigned int mid = low + (high - low) / 2;
+            const double* midKey = &groupKeys[(size_t)mid * numDim];
+            if (lexicographical_compare(midKey, midKey + numDim, key,
+                                        key + numDim)) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        if (low == groupStart.size() - 1 ||
+            !equal(key, key + numDim, &groupKeys[(size_t)low * numDim])) {
+            return groupStart.size();
+        }
+        return low;
+    }
+
+    /** Appends the ids of the input points at the location of point */
+    void appendIds(const Point& point, vector<unsigned int>& ids) const {
+        unsigned int group = groupOfPoint(point);
+        if (group == groupStart.size()) {
+            return;
+        }
+        ids.insert(ids.end(), groupIds.begin() + groupStart[group],
+                   groupIds.begin() + groupStart[group + 1]);
+    }
+
     /** Helper method to recursively build the subtrees of KD tree.
      *  @param points Vector of all data points to insert into the KD tree
      *  @param start Inclusive start index of points to insert into subtree
      *  @param end Exclusive end index of points to insert into subtree
-     *  @param curDim Current dimension when building subtree
-     *  @param height Current height during building subtree
-     *  @return root node of this subtree
+     *  @param parentDim Split dimension of the parent node
+     *  @param height Height of the parent node
+     *  @return index of root node of this subtree
      */
-    KDNode* buildSubtree(vector<Point>& points, unsigned int start,
-                         unsigned int end, unsigned int curDim, int height) {
+    unsigned int buildSubtree(vector<Point>& points, unsigned int start,
+                         unsigned int end, unsigned int parentDim,
+                         int height) {
         // base case
         if (start == end) {
-            return nullptr;
+            return NONE;
         }
 
-        // sort for this subtree
-        std::sort(points.begin() + start, points.begin() + end,
-                  CompareValueAt(curDim));
-
-        // set median as new node
-        int medianIndex = floor((start + end) / 2);
-        KDNode* current = new KDNode(points[medianIndex]);
+        // choose split of this subtree and set split point as new node
+        unsigned int curDim = 0;
+        unsigned int medianIndex =
+            chooseSplit(points, start, end, parentDim, splitRule, curDim);
+        unsigned int current = addNode(points[medianIndex], curDim);
 
         // increase tracking variables
         isize += 1;
@@ -177,97 +645,130 @@ class KDT {
         }
 
         // recursively build sub trees
-        current->left = buildSubtree(points, start, medianIndex,
-                                     (curDim + 1) % numDim, height);
-        current->right = buildSubtree(points, medianIndex + 1, end,
-                                      (curDim + 1) % numDim, height);
+        unsigned int left =
+            buildSubtree(points, start, medianIndex, curDim, height);
+        unsigned int right =
+            buildSubtree(points, medianIndex + 1, end, curDim, height);
+        nodes[current].left = left;
+        nodes[current].right = right;
 
         return current;
     }
 
     /** Helper method to recursively find the nearest neighbor of query
      *  point.
-     *  @param node Pointer points to the current KD node being checked
+     *  @param index Index of the current KD node being checked
      *  @param queryPoint The given query point
-     *  @param curDim The current dimension being checked
      */
-    void findNNHelper(KDNode* node, Point& queryPoint, unsigned int curDim) {
+    void findNNHelper(unsigned int index, Point& queryPoint) {
         // base case
-        if (node == nullptr) {
+        if (index == NONE) {
             return;
         }
+        KDNode& node = nodes[index];
+        KDT_STAT(stats.enter());
+        KDT_STAT(if (node.left == NONE && node.right == NONE) {
+            ++stats.leavesScanned;
+        });
 
-        // values of curDim to compare
-        double nodeVal = node->point.valueAt(curDim);
+        // values of split dimension to compare
+        unsigned int curDim = node.dim;
+        const double* features = coordsOf(index);
+        double nodeVal = features[curDim];
         double queryVal = queryPoint.valueAt(curDim);
 
-        unsigned int nextDim = (curDim + 1) % numDim;  // next dimension
-
         // if query larger than or equal to node, go right first
-        if (nodeVal <= queryVal) {
-            findNNHelper(node->right, queryPoint,
-                         nextDim);  // right
-
-            // if curDim difference squared < threshold, go left
-            if (std::pow(nodeVal - queryVal, 2) < threshold) {
-                findNNHelper(node->left, queryPoint, nextDim);
-            }
-        } else {  // go left first
-            findNNHelper(node->left, queryPoint,
-                         nextDim);  // right
+        const double* query = queryPoint.features.data();
+        unsigned int& nearChild = nodeVal <= queryVal ? node.right : node.left;
+        unsigned int& farChild = nodeVal <= queryVal ? node.left : node.right;
+        if (mayBeCloser(nearChild, query, 0, threshold)) {
+            findNNHelper(expand(nearChild), queryPoint);
+        } else {
+            KDT_STAT(if (nearChild != NONE) ++stats.prunedBranches);
+        }
 
-            // if curDim difference squared < threshold, go left
-            if (std::pow(nodeVal - queryVal, 2) < threshold) {
-                findNNHelper(node->right, queryPoint, nextDim);
-            }
+        // if distance to splitting plane (or far cell) < threshold, go there
+        if (mayBeCloser(farChild, query,
+                        metric.axis(nodeVal - queryVal, curDim), threshold)) {
+            findNNHelper(expand(farChild), queryPoint);
+        } else {
+            KDT_STAT(if (farChild != NONE) ++stats.prunedBranches);
         }
 
         // update threshold and nearestNeighbor for current node if needed
-        node->point.setDistToQuery(queryPoint);
-        if (node->point.distToQuery < threshold) {
-            threshold = node->point.distToQuery;
-            nearestNeighbor = node->point;
+        double dist = metric(features, query, numDim);
+        KDT_STAT(++stats.distanceEvals);
+        if (dist < threshold) {
+            threshold = dist;
+            nearestIndex = index;
         }
+        KDT_STAT(stats.leave());
     }
 
     /** Extra credit */
     /** Helper method to find all points inside the query region.
-     *  @param node Pointer points to current KD Node being checked
+     *  @param index Index of current KD Node being checked
      *  @param currBB The current bounding box that contains all points in this
      *                node and subtree
      *  @param queryRegion Query region to perform range search
-     *  @param curDim Current dimension being checked
+     *  @param result Container that points inside the region are added to
+     *  @param stats Statistics of this search
      */
-    void rangeSearchHelper(KDNode* node, vector<pair<double, double>>& curBB,
+    void rangeSearchHelper(unsigned int index,
+                           vector<pair<double, double>>& curBB,
                            vector<pair<double, double>>& queryRegion,
-                           unsigned int curDim) {
+                           vector<Point>& result, SearchStats& stats) {
         // base case
-        if (node == nullptr) {
+        if (index == NONE) {
             return;
         }
+        KDNode& node = nodes[index];
+        KDT_STAT(stats.enter());
+        KDT_STAT(if (node.left == NONE && node.right == NONE) {
+            ++stats.leavesScanned;
+        });
 
-        double nodeValue =
-            node->point.valueAt(curDim);  // value of node at curDim
-        unsigned int nextDim = (curDim + 1) % numDim;  // next dimension
+        // skip subtrees whose points all miss the region, and take whole
+        // subtrees whose points all lie inside it
+        if (builtCellBounds) {
+            int overlap = cellOverlap(index, queryRegion);
+            if (overlap != PARTIAL) {
+                if (overlap == INSIDE) {
+                    reportSubtree(index, result);
+                }
+                KDT_STAT(stats.leave());
+                return;
+            }
+        }
+
+        unsigned int curDim = node.dim;  // split dimension of node
+        const double* features = coordsOf(index);
+        double nodeValue = features[curDim];  // value of node at curDim
 
         // if curDim node value < queryLower, go right
         if (nodeValue < queryRegion[curDim].first) {
-            rangeSearchHelper(node->right, curBB, queryRegion, nextDim);
+            KDT_STAT(if (node.left != NONE) ++stats.prunedBranches);
+            rangeSearchHelper(expand(node.right), curBB, queryRegion, result,
+                              stats);
 
         } else if (queryRegion[curDim].second < nodeValue) {
             // if queryUpper < curDim node value, go left
-            rangeSearchHelper(node->left, curBB, queryRegion, nextDim);
+            KDT_STAT(if (node.right != NONE) ++stats.prunedBranches);
+            rangeSearchHelper(expand(node.left), curBB, queryRegion, result,
+                              stats);
 
         } else {  // nodeValue is between (inclusive) range, go both left right
-            rangeSearchHelper(node->right, curBB, queryRegion, nextDim);
-            rangeSearchHelper(node->left, curBB, queryRegion, nextDim);
+            rangeSearchHelper(expand(node.right), curBB, queryRegion, result,
+                              stats);
+            rangeSearchHelper(expand(node.left), curBB, queryRegion, result,
+                              stats);
 
             bool inRange = true;  // if current node's point is in region
 
             // check if other dimensions fall in query region
-            for (unsigned int dim = nextDim; dim != curDim;
+            for (unsigned int dim = (curDim + 1) % numDim; dim != curDim;
                  dim = (dim + 1) % numDim) {
-                double curVal = node->point.valueAt(dim);
+                double curVal = features[dim];
                 if (curVal < queryRegion[dim].first ||
                     queryRegion[dim].second < curVal) {  // if out of range
                     inRange = false;
@@ -277,25 +778,390 @@ class KDT {
 
             // add node if in region
             if (inRange) {
-                pointsInRange.emplace_back(node->point);
+                result.emplace_back(pointOf(index));
+            }
+        }
+        KDT_STAT(stats.leave());
+    }
+
+    /** Returns true if the point of a node lies inside the query region */
+    bool inRegion(unsigned int index,
+                  vector<pair<double, double>>& queryRegion) const {
+        const double* features = coordsOf(index);
+        for (unsigned int dim = 0; dim < numDim; dim++) {
+            double curVal = features[dim];
+            if (curVal < queryRegion[dim].first ||
+                queryRegion[dim].second < curVal) {
+                return false;
             }
         }
+        return true;
     }
 
-    /** Deletes every node in the KDT.
-     *  @param n Node to delete subtree of and the node itself.
+    /** Helper method for parallelRangeSearch. Wherever both children of a
+     *  node intersect the region, the right subtree is searched on another
+     *  thread into its own buffer, until forkDepth forks have been made along
+     *  the path. Below that the serial rangeSearchHelper takes over.
+     *  @param index Index of current KD Node being checked
+     *  @param queryRegion Query region to perform range search
+     *  @param result Container that points inside the region are added to
+     *  @param forkDepth Number of forks still allowed below this node
+     *  @param stats Statistics of this search; each task counts into its own
+     *               and they are merged once the task is joined
      */
-    static void deleteAll(KDNode* n) {
-        // base case
-        if (n == nullptr) {
-            return;
+    void parallelRangeHelper(unsigned int index,
+                             vector<pair<double, double>>& queryRegion,
+                             vector<Point>& result, int forkDepth,
+                             SearchStats& stats) {
+        vector<pair<double, double>> unusedBB;
+        while (index != NONE && forkDepth > 0) {
+            const KDNode& node = nodes[index];
+            double nodeValue = coordsOf(index)[node.dim];
+            if (nodeValue < queryRegion[node.dim].first) {
+                KDT_STAT(stats.enter());
+                KDT_STAT(if (node.left != NONE) ++stats.prunedBranches);
+                index = node.right;
+            } else if (queryRegion[node.dim].second < nodeValue) {
+                KDT_STAT(stats.enter());
+                KDT_STAT(if (node.right != NONE) ++stats.prunedBranches);
+                index = node.left;
+            } else if (node.left == NONE || node.right == NONE) {
+                break;
+            } else {
+                // both children intersect region, search them concurrently
+                KDT_STAT(stats.enter());
+                vector<Point> rightResult;
+                SearchStats rightStats;
+                KDT_STAT(rightStats.depth = stats.depth);
+                unsigned int right = node.right;
+                future<void> task = async(launch::async, [&]() {
+                    parallelRangeHelper(right, queryRegion, rightResult,
+                                        forkDepth - 1, rightStats);
+                });
+                vector<Point> leftResult;
+                parallelRangeHelper(node.left, queryRegion, leftResult,
+                                    forkDepth - 1, stats);
+                task.get();
+                KDT_STAT(stats.merge(rightStats));
+
+                // concatenate in the order rangeSearchHelper visits them
+                result.insert(result.end(),
+                              make_move_iterator(rightResult.begin()),
+                              make_move_iterator(rightResult.end()));
+                result.insert(result.end(),
+                              make_move_iterator(leftResult.begin()),
+                              make_move_iterator(leftResult.end()));
+                if (inRegion(index, queryRegion)) {
+                    result.emplace_back(pointOf(index));
+                }
+                return;
+            }
+        }
+        rangeSearchHelper(index, unusedBB, queryRegion, result, stats);
+    }
+
+    /** Appends a node for a point, split on dim, and copies the point's
+     *  features into coords.
+     *  @return Index of the new node
+     */
+    unsigned int addNode(const Point& point, unsigned int dim) {
+        nodes.emplace_back(dim);
+        coords.insert(coords.end(), point.features.begin(),
+                      point.features.begin() + numDim);
+        return nodes.size() - 1;
+    }
+
+    /** Returns the features of the point of a node */
+    const double* coordsOf(unsigned int index) const {
+        return &coords[(size_t)index * numDim];
+    }
+
+    /** Returns a copy of the point of a node, as searches report it */
+    Point pointOf(unsigned int index) const {
+        const double* features = coordsOf(index);
+        return Point(vector<double>(features, features + numDim));
+    }
+
+    /** Returns the child or root index for the points in [start, end) of
+     *  lazyPoints, which is NONE if there are none and otherwise a LAZY
+     *  index to a new entry of lazyRanges.
+     *  @param parentDim Split dimension of the parent node
+     *  @param height Height the root of the subtree will have
+     */
+    unsigned int lazyLink(unsigned int start, unsigned int end,
+                          unsigned int parentDim, int height) {
+        if (start == end) {
+            return NONE;
         }
+        lazyRanges.push_back({start, end, parentDim, height});
+        return LAZY | (unsigned int)(lazyRanges.size() - 1);
+    }
 
-        deleteAll(n->left);
-        deleteAll(n->right);
-        delete (n);
+    /** Builds the node a LAZY child or root index refers to, leaving its
+     *  children lazy, and replaces link with the index of the new node.
+     *  @param link Child or root index, updated in place
+     *  @return Index of the node link refers to, or NONE
+     */
+    unsigned int expand(unsigned int& link) {
+        if (link == NONE || !(link & LAZY)) {
+            return link;
+        }
+        LazyRange range = lazyRanges[link & ~LAZY];
+        unsigned int curDim = 0;
+        unsigned int medianIndex =
+            choosePartialSplit(lazyPoints, range.start, range.end,
+                               range.parentDim, builtSplitRule, curDim);
+        unsigned int current = addNode(lazyPoints[medianIndex], curDim);
+        if (builtCellBounds) {
+            addCellBounds(range.start, range.end);
+        }
+        if (range.height > iheight) {
+            iheight = range.height;
+        }
+        nodes[current].left =
+            lazyLink(range.start, medianIndex, curDim, range.height + 1);
+        nodes[current].right =
+            lazyLink(medianIndex + 1, range.end, curDim, range.height + 1);
+        link = current;
+        return current;
+    }
+
+    /** Returns the height a lazily built tree of size points is known to
+     *  have before any subtree is built. Median splits give floor(log2 size);
+     *  other rules only count nodes as they are built.
+     */
+    int lazyHeight(unsigned int size) const {
+        if (builtSplitRule != CYCLE && builtSplitRule != MAX_SPREAD) {
+            return -1;
+        }
+        int height = -1;
+        for (; size > 0; size >>= 1) {
+            height++;
+        }
+        return height;
+    }
+
+    /** Starts the search for a query point in state
+     *  @param resultIndex Position of the query point in its batch
+     */
+    void startQuery(NNQuery& state, const Point& queryPoint,
+                    unsigned int resultIndex) {
+        state.query = &queryPoint;
+        state.resultIndex = resultIndex;
+        state.threshold = numeric_limits<double>::max();
+        state.best = root;
+        state.visited = 0;
+        state.stack.clear();
+        pushNode(state, root);
+    }
+
+    /** Pushes a node onto the stack of a batched search and prefetches it.
+     *  @return false if there is no such node
+     */
+    bool pushNode(NNQuery& state, unsigned int index) {
+        if (index == NONE) {
+            return false;
+        }
+        KDT_PREFETCH(&nodes[index]);
+        state.stack.push_back({index, ARRIVE});
+        state.visited++;
+        return true;
+    }
+
+    /** Advances a batched search until it has to wait for memory, visiting
+     *  nodes in the same order as findNNHelper.
+     *  @return true once the search is finished
+     */
+    bool stepQuery(NNQuery& state) {
+        const double* query = state.query->features.data();
+        while (!state.stack.empty()) {
+            // the stack may grow below, so only use frame before pushing
+            NNFrame& frame = state.stack.back();
+            KDNode& node = nodes[frame.index];
+            double nodeVal = 0;
+            switch (frame.phase) {
+                case ARRIVE:
+                    // the node is loaded, now fetch its features
+                    frame.phase = DESCEND;
+                    KDT_PREFETCH(coordsOf(frame.index));
+                    return false;
+                case DESCEND: {
+                    frame.phase = FAR_SIDE;
+                    nodeVal = coordsOf(frame.index)[node.dim];
+                    unsigned int& child = nodeVal <= query[node.dim]
+                                              ? node.right
+                                              : node.left;
+                    if (mayBeCloser(child, query, 0, state.threshold) &&
+                        pushNode(state, expand(child))) {
+                        return false;
+                    }
+                    break;
+                }
+                case FAR_SIDE: {
+                    frame.phase = VISIT;
+                    nodeVal = coordsOf(frame.index)[node.dim];
+                    unsigned int& child = nodeVal <= query[node.dim]
+                                              ? node.left
+                                              : node.right;
+                    if (mayBeCloser(child, query,
+                                    metric.axis(nodeVal - query[node.dim],
+                                                node.dim),
+                                    state.threshold) &&
+                        pushNode(state, expand(child))) {
+                        return false;
+                    }
+                    break;
+                }
+                case VISIT: {
+                    double dist =
+                        metric(coordsOf(frame.index), query, numDim);
+                    if (dist < state.threshold) {
+                        state.threshold = dist;
+                        state.best = frame.index;
+                    }
+                    state.stack.pop_back();
+                    break;
+                }
+            }
+        }
+        return true;
+    }
+
+    // how the bounding box of a subtree relates to a query region
+    enum { DISJOINT, PARTIAL, INSIDE };
+
+    /** Returns the stored bounding box of the subtree rooted at index */
+    const float* cellOf(unsigned int index) const {
+        return &cellBounds[(size_t)index * numDim * 2];
+    }
+
+    /** Returns value as a float no larger than value */
+    static float roundDown(double value) {
+        float result = (float)value;
+        return result > value ? nextafterf(result, -INFINITY) : result;
+    }
+
+    /** Returns value as a float no smaller than value */
+    static float roundUp(double value) {
+        float result = (float)value;
+        return result < value ? nextafterf(result, INFINITY) : result;
+    }
+
+    /** Appends the bounding box of lazyPoints[start, end) for a new node */
+    void addCellBounds(unsigned int start, unsigned int end) {
+        vector<pair<double, double>> box(
+            numDim, make_pair(numeric_limits<double>::max(),
+                              numeric_limits<double>::lowest()));
+        for (unsigned int i = start; i < end; i++) {
+            for (unsigned int d = 0; d < numDim; d++) {
+                double value = lazyPoints[i].features[d];
+                box[d].first = min(box[d].first, value);
+                box[d].second = max(box[d].second, value);
+            }
+        }
+        for (unsigned int d = 0; d < numDim; d++) {
+            cellBounds.push_back(roundDown(box[d].first));
+            cellBounds.push_back(roundUp(box[d].second));
+        }
+    }
+
+    /** Computes the bounding box of every subtree of a fully built tree.
+     *  Children always come after their parent in nodes, so going through
+     *  the nodes backwards sees every child before its parent.
+     */
+    void computeCellBounds() {
+        cellBounds.resize((size_t)nodes.size() * numDim * 2);
+        for (size_t i = nodes.size(); i-- > 0;) {
+            float* cell = &cellBounds[i * numDim * 2];
+            const KDNode& node = nodes[i];
+            const double* features = coordsOf(i);
+            for (unsigned int d = 0; d < numDim; d++) {
+                cell[2 * d] = roundDown(features[d]);
+                cell[2 * d + 1] = roundUp(features[d]);
+            }
+            for (unsigned int child : {node.left, node.right}) {
+                if (child == NONE) continue;
+                const float* childCell = cellOf(child);
+                for (unsigned int d = 0; d < 2 * numDim; d += 2) {
+                    cell[d] = min(cell[d], childCell[d]);
+                    cell[d + 1] = max(cell[d + 1], childCell[d + 1]);
+                }
+            }
+        }
+    }
+
+    /** Returns true if the subtree at a child or root index may hold a point
+     *  closer to the query than threshold. Subtrees with a stored bounding
+     *  box are judged by the distance to it, others by planeBound.
+     *  @param planeBound Distance from the query to the splitting plane
+     *                    between it and the subtree, 0 if on the same side
+     */
+    bool mayBeCloser(unsigned int link, const double* query, double planeBound,
+                     double threshold) const {
+        if (link == NONE) {
+            return false;
+        }
+        if (!builtCellBounds || (link & LAZY)) {
+            return planeBound < threshold;
+        }
+        const float* cell = cellOf(link);
+        double bound = 0;
+        for (unsigned int d = 0; d < numDim; d++) {
+            double gap = 0;
+            if (query[d] < cell[2 * d]) {
+                gap = cell[2 * d] - query[d];
+            } else if (query[d] > cell[2 * d + 1]) {
+                gap = query[d] - cell[2 * d + 1];
+            }
+            bound = metric.combine(bound, metric.axis(gap, d));
+        }
+        return bound < threshold;
+    }
+
+    /** Returns whether the bounding box of the subtree at index is DISJOINT
+     *  from, PARTIAL to or INSIDE the query region.
+     */
+    int cellOverlap(unsigned int index,
+                    vector<pair<double, double>>& queryRegion) const {
+        const float* cell = cellOf(index);
+        int overlap = INSIDE;
+        for (unsigned int d = 0; d < numDim; d++) {
+            if (cell[2 * d] > queryRegion[d].second ||
+                cell[2 * d + 1] < queryRegion[d].first) {
+                return DISJOINT;
+            }
+            if (cell[2 * d] < queryRegion[d].first ||
+                cell[2 * d + 1] > queryRegion[d].second) {
+                overlap = PARTIAL;
+            }
+        }
+        return overlap;
+    }
+
+    /** Adds every point of the subtree at a child or root index to result,
+     *  in the same right, left, node order as rangeSearchHelper. Subtrees
+     *  not built yet are added as they are, without building them.
+     */
+    void reportSubtree(unsigned int link, vector<Point>& result) const {
+        if (link == NONE) {
+            return;
+        }
+        if (link & LAZY) {
+            const LazyRange& range = lazyRanges[link & ~LAZY];
+            result.insert(result.end(), lazyPoints.begin() + range.start,
+                          lazyPoints.begin() + range.end);
+            return;
+        }
+        const KDNode& node = nodes[link];
+        reportSubtree(node.right, result);
+        reportSubtree(node.left, result);
+        result.emplace_back(pointOf(link));
     }
 
     // Add your own helper methods here
 };
+
+/** KD tree using squared Euclidean distance */
+typedef BasicKDT<SquaredEuclidean> KDT;
+
 #endif  // KDT_HPP
@@ -0,0 +1,172 @@
+/**
+ * Distance metric policies used by KDT and NaiveSearch.
+ *
+ * Every metric works on raw feature arrays and provides:
+ *   - operator()(a, b, numDim): the distance between a and b, in the metric's
+ *     comparable form (e.g. squared for Euclidean metrics, so no sqrt is
+ *     needed when only comparing distances).
+ *   - axis(diff, dim): the contribution of a gap diff along dimension dim.
+ *     A point separated from the query by diff along dim is at least this far
+ *     away, which is what makes pruning across a splitting plane correct.
+ *   - combine(acc, term): folds one axis term into an accumulated bound, so a
+ *     lower bound to a whole cell is combine over axis(gap_d, d) for each d.
+ *   - trueDistance(dist): converts a comparable distance to the actual
+ *     metric distance, which obeys the triangle inequality (used by VPTree).
+ *
+ * Metrics are plain structs used as template policies, so each kernel is
+ * inlined into the search loop without any virtual dispatch.
+ */
+
+#ifndef Metric_hpp
+#define Metric_hpp
+
+#include <math.h>
+#include <vector>
+
+using namespace std;
+
+/** Squared Euclidean distance (the default metric) */
+struct SquaredEuclidean {
+    /** Squared Euclidean distance between feature arrays a and b */
+    inline double operator()(const double* a, const double* b,
+                             unsigned int numDim) const {
+        // four independent accumulators so the loop can be vectorized
+        double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+        unsigned int i = 0;
+        for (; i + 4 <= numDim; i += 4) {
+            double d0 = a[i] - b[i];
+            double d1 = a[i + 1] - b[i + 1];
+            double d2 = a[i + 2] - b[i + 2];
+            double d3 = a[i + 3] - b[i + 3];
+            s0 += d0 * d0;
+            s1 += d1 * d1;
+            s2 += d2 * d2;
+            s3 += d3 * d3;
+        }
+        for (; i < numDim; i++) {
+            double d = a[i] - b[i];
+            s0 += d * d;
+        }
+        return (s0 + s1) + (s2 + s3);
+    }
+
+    /** Squared gap along one dimension */
+    inline double axis(double diff, unsigned int) const { return diff * diff; }
+
+    /** Squared distances add up over dimensions */
+    inline double combine(double acc, double term) const { return acc + term; }
+
+    /** Euclidean distance from squared Euclidean distance */
+    inline double trueDistance(double dist) const { return sqrt(dist); }
+};
+
+/** Manhattan (L1) distance */
+struct Manhattan {
+    /** Sum of absolute differences between feature arrays a and b */
+    inline double operator()(const double* a, const double* b,
+                             unsigned int numDim) const {
+        double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+        unsigned int i = 0;
+        for (; i + 4 <= numDim; i += 4) {
+            s0 += fabs(a[i] - b[i]);
+            s1 += fabs(a[i + 1] - b[i + 1]);
+            s2 += fabs(a[i + 2] - b[i + 2]);
+            s3 += fabs(a[i + 3] - b[i + 3]);
+        }
+        for (; i < numDim; i++) {
+            s0 += fabs(a[i] - b[i]);
+        }
+        return (s0 + s1) + (s2 + s3);
+    }
+
+    /** Absolute gap along one dimension */
+    inline double axis(double diff, unsigned int) const { return fabs(diff); }
+
+    /** L1 distances add up over dimensions */
+    inline double combine(double acc, double term) const { return acc + term; }
+
+    /** L1 distance is already a true distance */
+    inline double trueDistance(double dist) const { return dist; }
+};
+
+/** Chebyshev (L-infinity) distance */
+struct Chebyshev {
+    /** Largest absolute difference between feature arrays a and b */
+    inline double operator()(const double* a, const double* b,
+                             unsigned int numDim) const {
+        double m0 = 0, m1 = 0;
+        unsigned int i = 0;
+        for (; i + 2 <= numDim; i += 2) {
+            double d0 = fabs(a[i] - b[i]);
+            double d1 = fabs(a[i + 1] - b[i + 1]);
+            m0 = d0 > m0 ? d0 : m0;
+            m1 = d1 > m1 ? d1 : m1;
+        }
+        if (i < numDim) {
+            double d = fabs(a[i] - b[i]);
+            m0 = d > m0 ? d : m0;
+        }
+        return m0 > m1 ? m0 : m1;
+    }
+
+    /** Absolute gap along one dimension */
+    inline double axis(double diff, unsigned int) const { return fabs(diff); }
+
+    /** L-infinity bounds take the largest axis gap */
+    inline double combine(double acc, double term) const {
+        return term > acc ? term : acc;
+    }
+
+    /** L-infinity distance is already a true distance */
+    inline double trueDistance(double dist) const { return dist; }
+};
+
+/** Squared Euclidean distance with a non-negative weight per dimension */
+struct WeightedSquaredEuclidean {
+    // weight of each dimension; must have one entry per feature
+    vector<double> weights;
+
+    /** Default constructor, only useful before assigning weights */
+    WeightedSquaredEuclidean() {}
+
+    /** Constructor that sets the weight of every dimension */
+    WeightedSquaredEuclidean(vector<double> weights) : weights(weights) {}
+
+    /** Weighted squared Euclidean distance between feature arrays a and b */
+    inline double operator()(const double* a, const double* b,
+                             unsigned int numDim) const {
+        const double* w = weights.data();
+        double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+        unsigned int i = 0;
+        for (; i + 4 <= numDim; i += 4) {
+            double d0 = a[i] - b[i];
+            double d1 = a[i + 1] - b[i + 1];
+            double d2 = a[i + 2] - b[i + 2];
+            double d3 = a[i + 3] - b[i + 3];
+            s0 += w[i] * d0 * d0;
+            s1 += w[i + 1] * d1 * d1;
+            s2 += w[i + 2] * d2 * d2;
+            s3 += w[i + 3] * d3 * d3;
+        }
+        for (; i < numDim; i++) {
+            double d = a[i] - b[i];
+            s0 += w[i] * d * d;
+        }
+        return (s0 + s1) + (s2 + s3);
+    }
+
+    /** Weighted squared gap along one dimension */
+    inline double axis(double diff, unsigned int dim) const {
+        return weights[dim] * diff * diff;
+    }
+
+    /** Weighted squared distances add up over dimensions */
+    inline double combine(double acc, double term) const { return acc + term; }
+
+    /** Weighted Euclidean distance from its square. This is a true distance
+     *  as long as every weight is positive.
+     */
+    inline double trueDistance(double dist) const { return sqrt(dist); }
+};
+
+#endif /* Metric_hpp */
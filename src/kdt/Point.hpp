@@ -6,8 +6,11 @@
 #define Point_hpp
 
 #include <math.h>
+#include <limits>
 #include <string>
+#include <utility>
 #include <vector>
+#include "Metric.hpp"
 
 using namespace std;
 
@@ -22,7 +25,8 @@ class Point {
     // number of features
     unsigned int numDim;
 
-    // squared Euclidean distance to current query point
+    // distance to current query point, squared Euclidean unless another
+    // metric was given to setDistToQuery
     double distToQuery;
 
     /** Default constructor */
@@ -34,15 +38,18 @@ class Point {
 
     /** Set the square distance to the current query point */
     void setDistToQuery(const Point& queryPoint) {
-        double result = 0;
-        for (unsigned int i = 0; i < numDim; i++) {
-            result += pow(features[i] - queryPoint.features[i], 2.0);
-        }
-        distToQuery = result;
+        setDistToQuery(queryPoint, SquaredEuclidean());
+    }
+
+    /** Set the distance to the current query point under the given metric */
+    template <class Metric>
+    void setDistToQuery(const Point& queryPoint, const Metric& metric) {
+        distToQuery =
+            metric(features.data(), queryPoint.features.data(), numDim);
     }
 
     /** Return the value at dimension d of this point */
-    double valueAt(int d) { return features[d]; }
+    double valueAt(int d) const { return features[d]; }
 
     /** Equals operator */
     bool operator==(const Point& other) const {
@@ -80,6 +87,27 @@ struct CompareValueAt {
     }
 };
 
+/** Returns the smallest box containing all points, as a (lower, upper)
+ *  pair for each dimension. Returns an empty box if there are no points.
+ */
+inline vector<pair<double, double>> boundingBoxOf(const vector<Point>& points) {
+    vector<pair<double, double>> box;
+    if (points.empty()) {
+        return box;
+    }
+    for (unsigned int i = 0; i < points[0].numDim; i++) {
+        box.emplace_back(numeric_limits<double>::max(),
+                         numeric_limits<double>::lowest());
+    }
+    for (const Point& p : points) {
+        for (unsigned int i = 0; i < box.size(); i++) {
+            if (p.valueAt(i) < box[i].first) box[i].first = p.valueAt(i);
+            if (p.valueAt(i) > box[i].second) box[i].second = p.valueAt(i);
+        }
+    }
+    return box;
+}
+
 // Example of another comparator. When used in sort(), 
 // points will be ordered from small to large distToQurey
 // struct CompareDist {
@@ -0,0 +1,140 @@
+/**
+ * Per-query search statistics for KDT.
+ *
+ * Counters are only collected when the code is compiled with KDT_STATS
+ * defined (meson option kdt_stats=true). Otherwise every KDT_STAT statement
+ * expands to nothing and the counters stay at zero.
+ */
+
+#ifndef SearchStats_hpp
+#define SearchStats_hpp
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#ifdef KDT_STATS
+#define KDT_STAT(statement) statement
+#else
+#define KDT_STAT(statement)
+#endif
+
+/** Work done by one search */
+struct SearchStats {
+#ifdef KDT_STATS
+    static const bool enabled = true;
+#else
+    static const bool enabled = false;
+#endif
+
+    // nodes whose point was looked at
+    unsigned long long nodesVisited;
+    // visited nodes without children
+    unsigned long long leavesScanned;
+    // distances computed with the metric
+    unsigned long long distanceEvals;
+    // child subtrees skipped because they could not hold a result
+    unsigned long long prunedBranches;
+    // deepest level reached, with the root at depth 1
+    unsigned int maxDepth;
+    // depth of the node currently being visited
+    unsigned int depth;
+
+    SearchStats() { reset(); }
+
+    /** Clears every counter before a new search */
+    void reset() {
+        nodesVisited = leavesScanned = distanceEvals = prunedBranches = 0;
+        maxDepth = depth = 0;
+    }
+
+    /** Records entering a node one level below the current one */
+    void enter() {
+        ++nodesVisited;
+        if (++depth > maxDepth) maxDepth = depth;
+    }
+
+    /** Records leaving the current node */
+    void leave() { --depth; }
+
+    /** Adds the counters of a search done in parallel with this one */
+    void merge(const SearchStats& other) {
+        nodesVisited += other.nodesVisited;
+        leavesScanned += other.leavesScanned;
+        distanceEvals += other.distanceEvals;
+        prunedBranches += other.prunedBranches;
+        if (other.maxDepth > maxDepth) maxDepth = other.maxDepth;
+    }
+};
+
+/** Histograms of SearchStats counters over many searches. Values are
+ *  bucketed by powers of two: bucket 0 holds 0, bucket k holds
+ *  [2^(k-1), 2^k).
+ */
+class StatsHistogram {
+  private:
+    static const int NUM_COUNTERS = 5;
+    static const int NUM_BUCKETS = 40;
+
+    unsigned long long numSearches;
+    unsigned long long buckets[NUM_COUNTERS][NUM_BUCKETS];
+    unsigned long long totals[NUM_COUNTERS];
+    unsigned long long maxima[NUM_COUNTERS];
+
+    /** Returns the bucket of a value */
+    static int bucketOf(unsigned long long value) {
+        int bucket = 0;
+        while (value > 0 && bucket < NUM_BUCKETS - 1) {
+            value >>= 1;
+            bucket++;
+        }
+        return bucket;
+    }
+
+  public:
+    StatsHistogram() : numSearches(0) {
+        for (int c = 0; c < NUM_COUNTERS; c++) {
+            totals[c] = maxima[c] = 0;
+            for (int b = 0; b < NUM_BUCKETS; b++) buckets[c][b] = 0;
+        }
+    }
+
+    /** Adds the counters of one search */
+    void add(const SearchStats& stats) {
+        unsigned long long values[NUM_COUNTERS] = {
+            stats.nodesVisited, stats.leavesScanned, stats.distanceEvals,
+            stats.prunedBranches, stats.maxDepth};
+        numSearches++;
+        for (int c = 0; c < NUM_COUNTERS; c++) {
+            buckets[c][bucketOf(values[c])]++;
+            totals[c] += values[c];
+            if (values[c] > maxima[c]) maxima[c] = values[c];
+        }
+    }
+
+    /** Prints mean, max and the non-empty buckets of every counter */
+    void print(ostream& out, const string& title) const {
+        const char* names[NUM_COUNTERS] = {"nodes visited", "leaves scanned",
+                                           "distance evals", "pruned branches",
+                                           "max depth"};
+        out << title << " (" << numSearches << " searches)" << endl;
+        if (numSearches == 0) return;
+        for (int c = 0; c < NUM_COUNTERS; c++) {
+            out << "  " << names[c] << ": mean "
+                << (double)totals[c] / numSearches << ", max " << maxima[c]
+                << endl;
+            for (int b = 0; b < NUM_BUCKETS; b++) {
+                if (buckets[c][b] == 0) continue;
+                unsigned long long low = b == 0 ? 0 : 1ULL << (b - 1);
+                unsigned long long high = b == 0 ? 0 : (1ULL << b) - 1;
+                out << "    [" << setw(8) << low << ", " << setw(8) << high
+                    << "] " << buckets[c][b] << endl;
+            }
+        }
+    }
+};
+
+#endif /* SearchStats_hpp */
@@ -0,0 +1,195 @@
+/**
+ * Rules used by KDT to pick the split dimension and split point of a node.
+ */
+
+#ifndef SplitRule_hpp
+#define SplitRule_hpp
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include "Point.hpp"
+
+using namespace std;
+
+/** How KDT chooses the split dimension and split point of each node */
+enum SplitRule {
+    // cycle through dimensions, split at the median (the classic KD tree)
+    CYCLE,
+    // split the dimension with the largest spread at the median
+    MAX_SPREAD,
+    // split the dimension with the largest spread at the point closest to
+    // the middle of that spread, or at the median when that would leave
+    // fewer than a quarter of the points on one side
+    SLIDING_MIDPOINT,
+    // split where the summed half perimeters of both child boxes, weighted
+    // by their point counts, is smallest
+    SURFACE_AREA
+};
+
+/** Returns the dimension with the largest spread among points in
+ *  [start, end), along with that spread's lower and upper value.
+ */
+inline unsigned int maxSpreadDim(vector<Point>& points, unsigned int start,
+                                 unsigned int end, double& lower,
+                                 double& upper) {
+    unsigned int numDim = points[start].numDim;
+    unsigned int bestDim = 0;
+    double bestSpread = -1;
+    for (unsigned int dim = 0; dim < numDim; dim++) {
+        double lo = numeric_limits<double>::max();
+        double hi = numeric_limits<double>::lowest();
+        for (unsigned int i = start; i < end; i++) {
+            double value = points[i].features[dim];
+            lo = min(lo, value);
+            hi = max(hi, value);
+        }
+        if (hi - lo > bestSpread) {
+            bestSpread = hi - lo;
+            bestDim = dim;
+            lower = lo;
+            upper = hi;
+        }
+    }
+    return bestDim;
+}
+
+/** Finds the split index with the lowest surface area cost along dim.
+ *  Points in [start, end) must be sorted by dim. Only indices in the middle
+ *  half of the range are considered so the tree stays O(log n) deep.
+ *  @param cost Set to the cost of the returned index
+ *  @return Index of the point that should become the node
+ */
+inline unsigned int surfaceAreaIndex(vector<Point>& points, unsigned int start,
+                                     unsigned int end, double& cost) {
+    unsigned int numDim = points[start].numDim;
+    unsigned int count = end - start;
+
+    // halfPerimeter[k] is the summed extent of the box around the first k
+    // (prefix) or last k (suffix) points of the range
+    vector<double> prefix(count + 1, 0), suffix(count + 1, 0);
+    vector<double> lo(numDim), hi(numDim);
+    for (int pass = 0; pass < 2; pass++) {
+        vector<double>& halfPerimeter = pass == 0 ? prefix : suffix;
+        fill(lo.begin(), lo.end(), numeric_limits<double>::max());
+        fill(hi.begin(), hi.end(), numeric_limits<double>::lowest());
+        for (unsigned int k = 1; k <= count; k++) {
+            Point& p = points[pass == 0 ? start + k - 1 : end - k];
+            double sum = 0;
+            for (unsigned int dim = 0; dim < numDim; dim++) {
+                lo[dim] = min(lo[dim], p.features[dim]);
+                hi[dim] = max(hi[dim], p.features[dim]);
+                sum += hi[dim] - lo[dim];
+            }
+            halfPerimeter[k] = sum;
+        }
+    }
+
+    unsigned int first = start + count / 4;
+    unsigned int last = end - 1 - count / 4;
+    unsigned int bestIndex = start + count / 2;
+    cost = numeric_limits<double>::max();
+    for (unsigned int i = first; i <= last; i++) {
+        unsigned int numLeft = i - start;
+        unsigned int numRight = end - i - 1;
+        double c = prefix[numLeft] * numLeft + suffix[numRight] * numRight;
+        if (c < cost) {
+            cost = c;
+            bestIndex = i;
+        }
+    }
+    return bestIndex;
+}
+
+/** Chooses the split of points in [start, end) under the given rule.
+ *  On return the range is sorted by the split dimension, so every point
+ *  before the returned index is <= it and every point after is >= it.
+ *  @param parentDim Split dimension of the parent node
+ *  @param dim Set to the split dimension
+ *  @return Index of the point that should become the node
+ */
+inline unsigned int chooseSplit(vector<Point>& points, unsigned int start,
+                                unsigned int end, unsigned int parentDim,
+                                SplitRule rule, unsigned int& dim) {
+    unsigned int numDim = points[start].numDim;
+    unsigned int medianIndex = (start + end) / 2;
+    double lower = 0;
+    double upper = 0;
+
+    switch (rule) {
+        case CYCLE:
+            dim = (parentDim + 1) % numDim;
+            break;
+        case MAX_SPREAD:
+        case SLIDING_MIDPOINT:
+            dim = maxSpreadDim(points, start, end, lower, upper);
+            break;
+        case SURFACE_AREA: {
+            // try every dimension and keep the cheapest split
+            double bestCost = numeric_limits<double>::max();
+            unsigned int bestIndex = medianIndex;
+            dim = 0;
+            for (unsigned int d = 0; d < numDim; d++) {
+                std::sort(points.begin() + start, points.begin() + end,
+                          CompareValueAt(d));
+                double cost = 0;
+                unsigned int index = surfaceAreaIndex(points, start, end, cost);
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestIndex = index;
+                    dim = d;
+                }
+            }
+            if (dim != numDim - 1) {
+                std::sort(points.begin() + start, points.begin() + end,
+                          CompareValueAt(dim));
+            }
+            return bestIndex;
+        }
+    }
+
+    std::sort(points.begin() + start, points.begin() + end,
+              CompareValueAt(dim));
+
+    // sliding midpoint: first point at or past the middle of the spread.
+    // Falls back to the median when all points share the same value, or
+    // when the midpoint is so lopsided that skewed data (e.g. values
+    // halving at every step) would grow the tree O(n) deep.
+    if (rule == SLIDING_MIDPOINT && upper > lower) {
+        double mid = (lower + upper) / 2;
+        unsigned int index = start;
+        while (points[index].features[dim] < mid) {
+            index++;
+        }
+        unsigned int smaller = min(index - start, end - index - 1);
+        if (smaller >= (end - start) / 4) return index;
+    }
+    return medianIndex;
+}
+
+/** Like chooseSplit, but the median rules (CYCLE and MAX_SPREAD) only
+ *  partition the range around the median in O(end - start) time instead of
+ *  sorting it. Points equal to the median may end up on either side. The
+ *  other rules need the range sorted and fall back to chooseSplit.
+ */
+inline unsigned int choosePartialSplit(vector<Point>& points,
+                                       unsigned int start, unsigned int end,
+                                       unsigned int parentDim, SplitRule rule,
+                                       unsigned int& dim) {
+    if (rule != CYCLE && rule != MAX_SPREAD) {
+        return chooseSplit(points, start, end, parentDim, rule, dim);
+    }
+    unsigned int medianIndex = (start + end) / 2;
+    if (rule == CYCLE) {
+        dim = (parentDim + 1) % points[start].numDim;
+    } else {
+        double lower = 0;
+        double upper = 0;
+        dim = maxSpreadDim(points, start, end, lower, upper);
+    }
+    std::nth_element(points.begin() + start, points.begin() + medianIndex,
+                     points.begin() + end, CompareValueAt(dim));
+    return medianIndex;
+}
+
+#endif /* SplitRule_hpp */
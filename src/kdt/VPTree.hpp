@@ -0,0 +1,271 @@
+/**
+ * Vantage point tree over Points.
+ *
+ * Each node holds a vantage point and the median distance (radius) from it
+ * to the rest of its subtree: points no farther than the radius go inside,
+ * the others outside. Searching prunes with the triangle inequality instead
+ * of axis-aligned splits, so it keeps working in higher dimensions and with
+ * any metric whose trueDistance is a real distance.
+ */
+
+#ifndef VPTree_hpp
+#define VPTree_hpp
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+#include "Metric.hpp"
+#include "Point.hpp"
+
+using namespace std;
+
+template <class Metric = SquaredEuclidean>
+class BasicVPTree {
+  private:
+    // index used in place of a child or root that does not exist
+    enum : unsigned int { NONE = 0xFFFFFFFFu };
+
+    /** Inner class which defines a VP tree node */
+    class VPNode {
+      public:
+        Point point;
+        double radius;  // true distance splitting inside from outside
+        unsigned int inside;
+        unsigned int outside;
+
+        VPNode(const Point& point)
+            : point(point), radius(0), inside(NONE), outside(NONE) {}
+    };
+
+    // every node of the VP tree, allocated together in one block
+    vector<VPNode> nodes;
+
+    // index of root of VP tree
+    unsigned int root;
+
+    // number of dimension of data points
+    unsigned int numDim;
+
+    // distance metric used for searching
+    Metric metric;
+
+    // smallest true distance to query point so far
+    double threshold;
+
+    unsigned int isize;
+    int iheight;
+
+    // current nearest neighbor
+    Point nearestNeighbor;
+
+  public:
+    /** Constructor of VP tree
+     *  @param metric Distance metric used for searching
+     */
+    BasicVPTree(const Metric& metric = Metric())
+        : root(NONE),
+          numDim(0),
+          metric(metric),
+          threshold(numeric_limits<double>::max()),
+          isize(0),
+          iheight(-1) {}
+
+    /** Builds a balanced VP tree with points as input.
+     *  @param points Vector of points to put into the VP tree.
+     */
+    void build(vector<Point>& points) {
+        nodes.clear();
+        root = NONE;
+        isize = 0;
+        iheight = -1;
+        if (points.empty()) {
+            return;
+        }
+        numDim = points[0].numDim;
+        nodes.reserve(points.size());
+
+        // vantage points are picked at random, reproducibly per input size
+        mt19937 rng(points.size());
+        vector<pair<double, unsigned int>> order;
+        for (unsigned int i = 0; i < points.size(); i++) {
+            order.push_back(make_pair(0.0, i));
+        }
+        root = buildSubtree(points, order, 0, points.size(), -1, rng);
+    }
+
+    /** Returns a pointer to the nearest neighbor of a given query point in the
+     *  VP tree. If VP tree is empty, return nullptr.
+     *  @param queryPoint Query point to find the nearest neighbor of
+     */
+    Point* findNearestNeighbor(Point& queryPoint) {
+        if (isize == 0) {
+            return nullptr;
+        }
+        threshold = numeric_limits<double>::max();
+        findNNHelper(root, queryPoint);
+        return &nearestNeighbor;
+    }
+
+    /** Returns a vector containing all points inside query region.
+     *  @param queryRegion The query region to perform region search
+     */
+    vector<Point> rangeSearch(vector<pair<double, double>>& queryRegion) {
+        vector<Point> result;
+        rangeSearchHelper(root, queryRegion, result);
+        return result;
+    }
+
+    /** Returns the number of points in the VP tree */
+    unsigned int size() const { return isize; }
+
+    /** Returns the height of the VP tree. Empty tree has height -1 and a tree
+     *  with one node has height 0.
+     */
+    int height() const { return iheight; }
+
+  private:
+    /** Returns the true distance between two points */
+    double distance(const Point& p1, const Point& p2) const {
+        return metric.trueDistance(
+            metric(p1.features.data(), p2.features.data(), numDim));
+    }
+
+    /** Helper method to recursively build the subtrees of VP tree.
+     *  @param order Pairs of scratch distance and point index
+     *  @param start Inclusive start index into order of this subtree
+     *  @param end Exclusive end index into order of this subtree
+     *  @param height Height of the parent node
+     *  @return index of root node of this subtree
+     */
+    unsigned int buildSubtree(vector<Point>& points,
+                              vector<pair<double, unsigned int>>& order,
+                              unsigned int start, unsigned int end,
+                              int height, mt19937& rng) {
+        if (start == end) {
+            return NONE;
+        }
+
+        // move a random vantage point to the front of the range
+        uniform_int_distribution<unsigned int> pick(start, end - 1);
+        swap(order[start], order[pick(rng)]);
+        const Point& vantage = points[order[start].second];
+        unsigned int current = nodes.size();
+        nodes.emplace_back(vantage);
+
+        isize += 1;
+        height += 1;
+        if (height > iheight) {
+            iheight = height;
+        }
+
+        // split the rest at the median distance from the vantage point
+        unsigned int mid = (start + 1 + end) / 2;
+        if (start + 1 < end) {
+            for (unsigned int i = start + 1; i < end; i++) {
+                order[i].first = distance(vantage, points[order[i].second]);
+            }
+            nth_element(order.begin() + start + 1, order.begin() + mid,
+                        order.begin() + end);
+            nodes[current].radius = order[mid].first;
+        }
+
+        unsigned int inside =
+            buildSubtree(points, order, start + 1, mid, height, rng);
+        unsigned int outside =
+            buildSubtree(points, order, mid, end, height, rng);
+        nodes[current].inside = inside;
+        nodes[current].outside = outside;
+        return current;
+    }
+
+    /** Helper method to recursively find the nearest neighbor of query
+     *  point. Points inside a node are within radius of its vantage point and
+     *  points outside are at least radius away, so by the triangle
+     *  inequality a side can only hold a closer point when the query's
+     *  distance to the vantage point is within threshold of the radius.
+     *  @param index Index of the current VP node being checked
+     *  @param queryPoint The given query point
+     */
+    void findNNHelper(unsigned int index, Point& queryPoint) {
+        if (index == NONE) {
+            return;
+        }
+        VPNode& node = nodes[index];
+        double dist = distance(node.point, queryPoint);
+        if (dist < threshold) {
+            threshold = dist;
+            nearestNeighbor = node.point;
+            nearestNeighbor.distToQuery =
+                metric(node.point.features.data(),
+                       queryPoint.features.data(), numDim);
+        }
+
+        // search the side the query is on first
+        if (dist <= node.radius) {
+            if (dist - node.radius < threshold) {
+                findNNHelper(node.inside, queryPoint);
+            }
+            if (node.radius - dist < threshold) {
+                findNNHelper(node.outside, queryPoint);
+            }
+        } else {
+            if (node.radius - dist < threshold) {
+                findNNHelper(node.outside, queryPoint);
+            }
+            if (dist - node.radius < threshold) {
+                findNNHelper(node.inside, queryPoint);
+            }
+        }
+    }
+
+    /** Helper method to find all points inside the query region. The inside
+     *  of a node is skipped when the region is farther than radius from the
+     *  vantage point, and the outside when the whole region is closer.
+     *  @param index Index of current VP node being checked
+     *  @param queryRegion Query region to perform range search
+     *  @param result Container that points inside the region are added to
+     */
+    void rangeSearchHelper(unsigned int index,
+                           vector<pair<double, double>>& queryRegion,
+                           vector<Point>& result) const {
+        if (index == NONE) {
+            return;
+        }
+        const VPNode& node = nodes[index];
+
+        // nearest and farthest distance from vantage point to the region
+        double nearBound = 0;
+        double farBound = 0;
+        bool inRegion = true;
+        for (unsigned int d = 0; d < numDim; d++) {
+            double value = node.point.features[d];
+            double low = queryRegion[d].first;
+            double high = queryRegion[d].second;
+            double gap = value < low ? low - value
+                                     : (value > high ? value - high : 0);
+            nearBound = metric.combine(nearBound, metric.axis(gap, d));
+            farBound = metric.combine(
+                farBound, metric.axis(max(fabs(value - low), fabs(value - high)),
+                                      d));
+            inRegion = inRegion && gap == 0;
+        }
+        nearBound = metric.trueDistance(nearBound);
+        farBound = metric.trueDistance(farBound);
+
+        if (inRegion) {
+            result.emplace_back(node.point);
+        }
+        if (nearBound <= node.radius) {
+            rangeSearchHelper(node.inside, queryRegion, result);
+        }
+        if (farBound >= node.radius) {
+            rangeSearchHelper(node.outside, queryRegion, result);
+        }
+    }
+};
+
+/** VP tree using Euclidean distance */
+typedef BasicVPTree<SquaredEuclidean> VPTree;
+
+#endif /* VPTree_hpp */
@@ -0,0 +1,96 @@
+/**
+ * Benchmark of the ordered containers on the actor name files. For each
+ * file and container, inserts every name in file order, then looks up every
+ * name in shuffled order and as many names that are not in the file, and
+ * prints one CSV row with the build time, lookup time per name and height.
+ *
+ * Usage: ./bstBenchmark <names file>...
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "AVL.hpp"
+#include "BST.hpp"
+#include "BTree.hpp"
+
+using namespace std;
+
+/** Returns the nonempty lines of a file */
+vector<string> readNames(const char* fileName) {
+    vector<string> names;
+    ifstream in(fileName, ios::binary);
+    string line;
+    while (getline(in, line)) {
+        if (!line.empty()) names.push_back(line);
+    }
+    return names;
+}
+
+/** Returns the nanoseconds since start */
+double nsSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start)
+        .count();
+}
+
+/** Height of std::set is not exposed */
+template <typename Tree>
+int heightOf(const Tree& tree) {
+    return tree.height();
+}
+int heightOf(const set<string>&) { return -1; }
+
+/** Builds a Tree from names and times lookups of queries, printing a row */
+template <typename Tree>
+void run(const string& file, const string& engine,
+         const vector<string>& names, const vector<string>& queries) {
+    auto start = chrono::steady_clock::now();
+    Tree tree;
+    for (const string& name : names) {
+        tree.insert(name);
+    }
+    double buildNs = nsSince(start);
+
+    start = chrono::steady_clock::now();
+    unsigned int found = 0;
+    for (const string& query : queries) {
+        if (tree.find(query) != tree.end()) found++;
+    }
+    double findNs = nsSince(start);
+
+    cout << file << "," << engine << "," << tree.size() << ","
+         << heightOf(tree) << "," << buildNs / 1e6 << ","
+         << findNs / queries.size() << "," << found << endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        cout << "Usage: ./bstBenchmark <names file>..." << endl;
+        return -1;
+    }
+    cout << "file,engine,size,height,build_ms,find_ns,found" << endl;
+    for (int i = 1; i < argc; i++) {
+        vector<string> names = readNames(argv[i]);
+
+        // every name once, and once with a suffix so it is missed
+        vector<string> queries = names;
+        for (const string& name : names) {
+            queries.push_back(name + " JR");
+        }
+        mt19937 rng(1);
+        shuffle(queries.begin(), queries.end(), rng);
+
+        string file = argv[i];
+        file = file.substr(file.find_last_of('/') + 1);
+        run<BST<string>>(file, "bst", names, queries);
+        run<AVL<string>>(file, "avl", names, queries);
+        run<BTree<string>>(file, "btree", names, queries);
+        run<set<string>>(file, "set", names, queries);
+    }
+    return 0;
+}
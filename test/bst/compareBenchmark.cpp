@@ -0,0 +1,99 @@
+/**
+ * Counts the string comparisons BST makes with a three-way comparator
+ * against a comparator built from two operator< calls, which is what insert
+ * and find did before. Each comparator builds a tree from a names file in
+ * file order and then looks up every name and as many missing names. One
+ * CSV row is printed per comparator.
+ *
+ * Usage: ./compareBenchmark <names file>
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "BST.hpp"
+
+using namespace std;
+
+// number of string comparisons made so far
+unsigned long long comparisons = 0;
+
+/** Compares with operator<, and a second time when a is not smaller */
+struct CountingLess {
+    int operator()(const string& a, const string& b) const {
+        ++comparisons;
+        if (a < b) return -1;
+        ++comparisons;
+        return b < a ? 1 : 0;
+    }
+};
+
+/** Compares with a single call to string::compare */
+struct CountingThreeWay {
+    int operator()(const string& a, const string& b) const {
+        ++comparisons;
+        return a.compare(b);
+    }
+};
+
+/** Builds a tree from names and looks up queries, printing a row */
+template <typename Compare>
+void run(const string& comparator, const vector<string>& names,
+         const vector<string>& queries) {
+    BST<string, Compare> tree;
+    comparisons = 0;
+    auto start = chrono::steady_clock::now();
+    for (const string& name : names) {
+        tree.insert(name);
+    }
+    double buildMs = chrono::duration<double, milli>(
+                         chrono::steady_clock::now() - start)
+                         .count();
+    unsigned long long buildComparisons = comparisons;
+
+    comparisons = 0;
+    start = chrono::steady_clock::now();
+    unsigned int found = 0;
+    for (const string& query : queries) {
+        if (tree.find(query) != tree.end()) found++;
+    }
+    double findNs = chrono::duration<double, nano>(
+                        chrono::steady_clock::now() - start)
+                        .count();
+
+    cout << comparator << "," << buildComparisons << ","
+         << (double)comparisons / queries.size() << "," << buildMs << ","
+         << findNs / queries.size() << "," << found << endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        cout << "Usage: ./compareBenchmark <names file>" << endl;
+        return -1;
+    }
+    vector<string> names;
+    ifstream in(argv[1], ios::binary);
+    string line;
+    while (getline(in, line)) {
+        if (!line.empty()) names.push_back(line);
+    }
+
+    // every name once, and once with a suffix so it is missed
+    vector<string> queries = names;
+    for (const string& name : names) {
+        queries.push_back(name + " JR");
+    }
+    mt19937 rng(1);
+    shuffle(queries.begin(), queries.end(), rng);
+
+    cout << "comparator,build_compares,compares_per_find,build_ms,find_ns,"
+            "found"
+         << endl;
+    run<CountingLess>("two_less", names, queries);
+    run<CountingThreeWay>("three_way", names, queries);
+    return 0;
+}
@@ -0,0 +1,115 @@
+/**
+ * Stress benchmark of lookups running while a writer keeps inserting. For
+ * each number of reader threads, a tree preloaded with names is searched by
+ * the readers for a fixed time while one writer inserts new names in sorted
+ * order, which rotates nodes all along. ConcurrentBST is compared against
+ * an AVL tree behind a mutex. One CSV row is printed per run.
+ *
+ * Usage: ./concurrentBenchmark [max readers] [milliseconds per run]
+ */
+
+#include <stdlib.h>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AVL.hpp"
+#include "ConcurrentBST.hpp"
+
+using namespace std;
+
+// names preloaded before the readers start
+const int NUM_PRELOADED = 100000;
+
+// lookups that found their name, kept so the lookups are not optimized out
+atomic<unsigned long long> hits(0);
+
+/** Returns the i-th name; the writer inserts names after the preloaded ones
+ */
+string nameOf(int i) {
+    ostringstream name;
+    name << "ACTOR " << setw(8) << setfill('0') << i;
+    return name.str();
+}
+
+/** AVL tree that locks a mutex around every operation */
+class LockedAVL {
+  private:
+    AVL<string> tree;
+    mutable mutex lock;
+
+  public:
+    bool insert(const string& item) {
+        lock_guard<mutex> guard(lock);
+        return tree.insert(item);
+    }
+    bool contains(const string& item) const {
+        lock_guard<mutex> guard(lock);
+        return tree.find(item) != tree.end();
+    }
+};
+
+/** Runs numReaders readers and one writer on a Tree for the given time */
+template <typename Tree>
+void run(const string& engine, unsigned int numReaders, int milliseconds) {
+    Tree tree;
+    for (int i = 0; i < NUM_PRELOADED; i++) {
+        tree.insert(nameOf(i));
+    }
+
+    atomic<bool> done(false);
+    vector<unsigned long long> reads(numReaders, 0);
+    vector<thread> readers;
+    for (unsigned int r = 0; r < numReaders; r++) {
+        readers.emplace_back([&, r]() {
+            mt19937 rng(r);
+            uniform_int_distribution<int> pick(0, 2 * NUM_PRELOADED);
+            unsigned long long count = 0;
+            unsigned long long found = 0;
+            while (!done.load(memory_order_relaxed)) {
+                found += tree.contains(nameOf(pick(rng)));
+                count++;
+            }
+            reads[r] = count;
+            hits += found;
+        });
+    }
+    unsigned long long writes = 0;
+    auto start = chrono::steady_clock::now();
+    auto stop = start + chrono::milliseconds(milliseconds);
+    while (chrono::steady_clock::now() < stop) {
+        tree.insert(nameOf(NUM_PRELOADED + writes));
+        writes++;
+    }
+    done.store(true);
+    for (thread& reader : readers) {
+        reader.join();
+    }
+    double seconds =
+        chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    unsigned long long totalReads = 0;
+    for (unsigned long long count : reads) totalReads += count;
+    cout << engine << "," << numReaders << "," << totalReads / seconds << ","
+         << writes / seconds << endl;
+}
+
+int main(int argc, char* argv[]) {
+    unsigned int maxReaders =
+        argc > 1 ? atoi(argv[1]) : thread::hardware_concurrency();
+    int milliseconds = argc > 2 ? atoi(argv[2]) : 500;
+    if (maxReaders == 0) maxReaders = 1;
+
+    cout << "engine,readers,reads_per_sec,writes_per_sec" << endl;
+    for (unsigned int readers = 1; readers <= maxReaders; readers *= 2) {
+        run<ConcurrentBST<string>>("optimistic", readers, milliseconds);
+        run<LockedAVL>("locked", readers, milliseconds);
+    }
+    return 0;
+}
@@ -12,6 +12,7 @@
 #include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <string>
 #include <vector>
 #include "BST.hpp"
@@ -73,13 +74,24 @@ void parseFiles(BST<string>& bst, vector<string>& queryNames, char* argv[],
     } else {
         in.open(argv[2], ios::binary);
     }
+    vector<string> names;
     while (!in.eof()) {
         getline(in, line);
         if (line.empty()) break;
-        bst.insert(line);
+        names.push_back(line);
     }
     in.close();
 
+    // an empty tree is bulk loaded balanced, otherwise insert one by one
+    if (bst.empty()) {
+        bst.buildFrom(make_move_iterator(names.begin()),
+                      make_move_iterator(names.end()));
+    } else {
+        for (string& name : names) {
+            bst.insert(std::move(name));
+        }
+    }
+
     // parse file for query names
     if (!printFlag) {
         in.open(argv[2], ios::binary);
@@ -106,7 +118,7 @@ int main(int argc, char* argv[]) {
     if (argc == NUM_ARG_FLAG) printFlag = true;
 
     // parse files to build BST and query vector
-    BST<string> tree = BST<string>();
+    BST<string> tree;
     vector<string> queryNames;
     parseFiles(tree, queryNames, argv, printFlag);
 
@@ -120,24 +132,22 @@ int main(int argc, char* argv[]) {
         cout << "false" << endl;
     }
 
-    // print find query results
-    result = "";
-    for (string& query : queryNames) {
-        if (tree.find(query) == tree.end()) {
-            result += "not found, ";
-        } else {
-            result += "found, ";
-        }
+    // print find query results, looked up in one ordered pass
+    vector<bool> found = tree.contains(queryNames);
+    cout << "Find results for query names: ";
+    for (size_t i = 0; i < found.size(); i++) {
+        if (i > 0) cout << ", ";
+        cout << (found[i] ? "found" : "not found");
     }
-    result = result.substr(0, result.length() - TRUC_LEN);
-    cout << "Find results for query names: " << result << endl;
+    cout << endl;
 
     if (printFlag) {
         // print inorder traversal
         inorderVec = tree.inorder();
         result = "";
         for (string& data : inorderVec) {
-            result += (data + ", ");
+            result += data;
+            result += ", ";
         }
         result = result.substr(0, result.length() - TRUC_LEN);
         cout << "Inorder traversal: " << result << endl;
@@ -145,7 +155,8 @@ int main(int argc, char* argv[]) {
         // print iterator traversal
         result = "";
         for (auto it = tree.begin(); it != tree.end(); it++) {
-            result += (*it + ", ");
+            result += *it;
+            result += ", ";
         }
         result = result.substr(0, result.length() - TRUC_LEN);
         cout << "Iterator traversal: " << result << endl;
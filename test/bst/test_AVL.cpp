@@ -0,0 +1,148 @@
+#include <math.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "AVL.hpp"
+#include "util.hpp"
+
+using namespace std;
+using namespace testing;
+
+/** Largest height an AVL tree with n nodes can have */
+int maxAVLHeight(unsigned int n) { return (int)(1.44 * log2(n + 2.0)); }
+
+TEST(AVLTests, EMPTY_TREE_TEST) {
+    AVL<int> avl;
+    ASSERT_EQ(avl.height(), -1);
+    ASSERT_TRUE(avl.empty());
+    ASSERT_EQ(avl.find(3), avl.end());
+    ASSERT_EQ(avl.begin(), avl.end());
+}
+
+TEST(AVLTests, SORTED_INSERT_TEST) {
+    AVL<int> avl;
+    vector<int> input;
+    for (int i = 0; i < 1000; i++) {
+        input.push_back(i);
+    }
+    insertIntoBST(input, avl);
+    // assert sorted input gives a balanced tree instead of a list
+    ASSERT_EQ(avl.size(), 1000);
+    ASSERT_LE(avl.height(), maxAVLHeight(1000));
+    ASSERT_EQ(avl.inorder(), input);
+    ASSERT_EQ(*avl.find(637), 637);
+}
+
+TEST(AVLTests, REVERSE_SORTED_INSERT_TEST) {
+    AVL<int> avl;
+    for (int i = 1023; i >= 0; i--) {
+        avl.insert(i);
+    }
+    // assert a complete tree of 1024 nodes has height 10
+    ASSERT_EQ(avl.height(), 10);
+    ASSERT_EQ(*avl.begin(), 0);
+}
+
+TEST(AVLTests, SMALL_ROTATION_TEST) {
+    // assert each of the four rotation cases keeps height 1
+    vector<vector<int>> cases{{1, 2, 3}, {3, 2, 1}, {1, 3, 2}, {3, 1, 2}};
+    for (vector<int>& input : cases) {
+        AVL<int> tree;
+        insertIntoBST(input, tree);
+        ASSERT_EQ(tree.height(), 1);
+        ASSERT_EQ(tree.inorder(), vector<int>({1, 2, 3}));
+    }
+}
+
+TEST(AVLTests, RANDOM_INSERT_TEST) {
+    AVL<int> avl;
+    set<int> expected;
+    mt19937 rng(17);
+    uniform_int_distribution<int> value(0, 5000);
+    for (int i = 0; i < 10000; i++) {
+        int item = value(rng);
+        // assert duplicates are rejected as in BST
+        ASSERT_EQ(avl.insert(item), expected.insert(item).second);
+    }
+    ASSERT_EQ(avl.size(), expected.size());
+    ASSERT_LE(avl.height(), maxAVLHeight(avl.size()));
+    // assert iterators walk the rotated tree in order
+    ASSERT_TRUE(equal(avl.begin(), avl.end(), expected.begin()));
+}
+
+TEST(AVLTests, SORTED_STRING_TEST) {
+    AVL<string> avl;
+    vector<string> names;
+    for (int i = 0; i < 500; i++) {
+        names.push_back("actor " + to_string(1000 + i));
+    }
+    insertIntoBST(names, avl);
+    // assert sorted names, like actors_sorted.txt, stay balanced
+    ASSERT_LE(avl.height(), maxAVLHeight(avl.size()));
+    ASSERT_EQ(*avl.find("actor 1250"), "actor 1250");
+    ASSERT_EQ(avl.find("actor 2000"), avl.end());
+}
+
+TEST(AVLTests, RANDOM_ERASE_TEST) {
+    AVL<int> avl;
+    set<int> expected;
+    mt19937 rng(29);
+    uniform_int_distribution<int> value(0, 2000);
+    for (int i = 0; i < 20000; i++) {
+        int item = value(rng);
+        // assert inserts and erases agree with std::set
+        if (i % 3 == 0) {
+            ASSERT_EQ(avl.erase(item), expected.erase(item) == 1);
+        } else {
+            ASSERT_EQ(avl.insert(item), expected.insert(item).second);
+        }
+        ASSERT_LE(avl.height(), maxAVLHeight(avl.size()));
+    }
+    ASSERT_EQ(avl.size(), expected.size());
+    ASSERT_TRUE(equal(avl.begin(), avl.end(), expected.begin()));
+}
+
+TEST(AVLTests, ERASE_SORTED_TEST) {
+    AVL<int> avl;
+    for (int i = 0; i < 1024; i++) {
+        avl.insert(i);
+    }
+    // assert erasing one side keeps the tree balanced
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_TRUE(avl.erase(i));
+    }
+    ASSERT_EQ(avl.size(), 24);
+    ASSERT_LE(avl.height(), maxAVLHeight(24));
+    ASSERT_EQ(*avl.begin(), 1000);
+}
+
+TEST(AVLTests, SELECT_RANK_TEST) {
+    AVL<int, ThreeWayCompare<int>, true> avl;
+    set<int> expected;
+    mt19937 rng(31);
+    uniform_int_distribution<int> value(0, 2000);
+    for (int i = 0; i < 20000; i++) {
+        int item = value(rng);
+        if (i % 3 == 0) {
+            avl.erase(item);
+            expected.erase(item);
+        } else {
+            avl.insert(item);
+            expected.insert(item);
+        }
+    }
+    // assert rotations keep the counts right
+    unsigned int k = 0;
+    for (int item : expected) {
+        ASSERT_EQ(*avl.select(k), item);
+        ASSERT_EQ(avl.rank(item), k);
+        k++;
+    }
+    ASSERT_EQ(avl.select(k), avl.end());
+}
@@ -1,6 +1,7 @@
 #include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <random>
 #include <set>
 #include <string>
 #include <vector>
@@ -144,4 +145,353 @@ TEST_F(SmallBSTFixture, FIND_DATA_TEST) {
 TEST_F(SmallBSTFixture, FIND_NONE_TEST) {
     // assert find works correctly when data not found
     ASSERT_EQ(bst.find(0), bst.end());
-}
\ No newline at end of file
+}
+
+TEST_F(SmallBSTFixture, ERASE_LEAF_TEST) {
+    // assert erasing the deepest leaf lowers the height
+    ASSERT_TRUE(bst.erase(100));
+    ASSERT_EQ(bst.height(), 2);
+    ASSERT_TRUE(bst.erase(-33));
+    ASSERT_EQ(bst.height(), 1);
+    ASSERT_FALSE(bst.erase(-33));
+    ASSERT_EQ(bst.size(), 3);
+    ASSERT_EQ(bst.inorder(), vector<int>({1, 3, 4}));
+}
+
+TEST_F(SmallBSTFixture, ERASE_ROOT_TEST) {
+    BST<int>::iterator four = bst.find(4);
+    // assert the successor is relinked in place of a node with two children
+    ASSERT_EQ(*bst.erase(bst.find(3)), 4);
+    ASSERT_EQ(bst.size(), 4);
+    ASSERT_EQ(bst.height(), 2);
+    ASSERT_EQ(bst.inorder(), vector<int>({-33, 1, 4, 100}));
+    // assert iterators to other items stay valid
+    ASSERT_EQ(*four, 4);
+    ASSERT_EQ(*(++four), 100);
+    ASSERT_EQ(bst.find(3), bst.end());
+}
+
+TEST(BSTTests, ERASE_ALL_TEST) {
+    BST<string> bst;
+    vector<string> input{"Kevin Bacon", "Tom Hanks", "Meryl Streep",
+                         "Emma Stone"};
+    insertIntoBST(input, bst);
+    // assert erasing while iterating empties the tree
+    BST<string>::iterator it = bst.begin();
+    while (it != bst.end()) {
+        it = bst.erase(it);
+    }
+    ASSERT_TRUE(bst.empty());
+    ASSERT_EQ(bst.height(), -1);
+    ASSERT_TRUE(bst.insert("Tom Hanks"));
+    ASSERT_EQ(bst.height(), 0);
+}
+
+TEST(BSTTests, DELETE_STRING_BST_TEST) {
+    BST<string>* bst = new BST<string>();
+    vector<string> input{"Kevin Bacon", "Tom Hanks", "Meryl Streep"};
+    insertIntoBST(input, *bst);
+    // assert a duplicate insert is rejected and later inserts still work
+    ASSERT_FALSE(bst->insert("Tom Hanks"));
+    ASSERT_TRUE(bst->insert("Emma Stone"));
+    ASSERT_EQ(bst->inorder(), vector<string>({"Emma Stone", "Kevin Bacon",
+                                              "Meryl Streep", "Tom Hanks"}));
+    // assert deconstructor destroys non-trivial data before releasing nodes
+    delete (bst);
+}
+
+TEST(BSTTests, LARGE_BST_TEST) {
+    BST<int> bst;
+    // insert enough nodes to span several pool chunks
+    for (int i = 0; i < 20000; i++) {
+        bst.insert((i * 7919) % 20000);
+    }
+    ASSERT_EQ(bst.size(), 20000);
+    int expected = 0;
+    for (BST<int>::iterator it = bst.begin(); it != bst.end(); ++it) {
+        ASSERT_EQ(*it, expected++);
+    }
+}
+
+TEST(BSTTests, BUILD_FROM_SORTED_TEST) {
+    BST<int> bst;
+    vector<int> input;
+    for (int i = 0; i < 1023; i++) {
+        input.push_back(i);
+    }
+    bst.buildFrom(input.begin(), input.end());
+    // assert sorted input is linked into a complete tree
+    ASSERT_EQ(bst.size(), 1023);
+    ASSERT_EQ(bst.height(), 9);
+    ASSERT_EQ(bst.inorder(), input);
+    // assert inserting afterwards keeps height and links correct
+    ASSERT_TRUE(bst.insert(5000));
+    ASSERT_EQ(bst.height(), 10);
+    ASSERT_EQ(*bst.find(5000), 5000);
+}
+
+TEST(BSTTests, BUILD_FROM_UNSORTED_TEST) {
+    BST<string> bst;
+    bst.insert("replaced");
+    vector<string> input{"Tom Hanks", "Emma Stone", "Kevin Bacon",
+                         "Tom Hanks", "Meryl Streep"};
+    bst.buildFrom(input.begin(), input.end());
+    // assert old contents are replaced and duplicates are kept once
+    ASSERT_EQ(bst.size(), 4);
+    ASSERT_EQ(bst.height(), 2);
+    ASSERT_EQ(bst.inorder(), vector<string>({"Emma Stone", "Kevin Bacon",
+                                             "Meryl Streep", "Tom Hanks"}));
+    ASSERT_EQ(bst.find("replaced"), bst.end());
+}
+
+TEST(BSTTests, BUILD_FROM_LARGE_TEST) {
+    BST<int> bst;
+    vector<int> input;
+    for (int i = 0; i < 200000; i++) {
+        input.push_back((i * 7919) % 100000);
+    }
+    // assert large input sorted on several threads builds correctly
+    bst.buildFrom(input.begin(), input.end());
+    ASSERT_EQ(bst.size(), 100000);
+    ASSERT_EQ(bst.height(), 16);
+    int expected = 0;
+    for (BST<int>::iterator it = bst.begin(); it != bst.end(); ++it) {
+        ASSERT_EQ(*it, expected++);
+    }
+}
+
+/** Orders ints from largest to smallest */
+struct Descending {
+    int operator()(int a, int b) const { return b < a ? -1 : (a < b ? 1 : 0); }
+};
+
+TEST(BSTTests, CUSTOM_COMPARE_TEST) {
+    BST<int, Descending> bst;
+    vector<int> input{3, 4, 1, 100, -33};
+    for (int item : input) {
+        bst.insert(item);
+    }
+    // assert the comparator decides order, duplicates and lookups
+    ASSERT_FALSE(bst.insert(4));
+    ASSERT_EQ(bst.inorder(), vector<int>({100, 4, 3, 1, -33}));
+    ASSERT_EQ(*bst.find(1), 1);
+    bst.buildFrom(input.begin(), input.end());
+    ASSERT_EQ(bst.inorder(), vector<int>({100, 4, 3, 1, -33}));
+}
+
+TEST(BSTTests, THREE_WAY_COMPARE_TEST) {
+    ThreeWayCompare<string> strings;
+    ThreeWayCompare<int> ints;
+    // assert both comparators return the sign of the order
+    ASSERT_LT(strings("HUGH JACKMAN", "HUGH LAURIE"), 0);
+    ASSERT_GT(strings("HUGH", "HUG"), 0);
+    ASSERT_EQ(strings("BRAD PITT", "BRAD PITT"), 0);
+    ASSERT_LT(ints(-3, 2), 0);
+    ASSERT_GT(ints(5, 2), 0);
+    ASSERT_EQ(ints(2, 2), 0);
+}
+
+/** Item that counts how often it is copied */
+struct Tracked {
+    static int copies;
+    int key;
+
+    Tracked(int key) : key(key) {}
+    Tracked(const Tracked& other) : key(other.key) { ++copies; }
+    Tracked(Tracked&& other) : key(other.key) {}
+    bool operator<(const Tracked& other) const { return key < other.key; }
+};
+int Tracked::copies = 0;
+
+TEST(BSTTests, INSERT_WITHOUT_COPIES_TEST) {
+    BST<Tracked> bst;
+    Tracked three(3);
+    Tracked::copies = 0;
+    // assert moving and emplacing never copy, and a duplicate costs nothing
+    ASSERT_TRUE(bst.insert(Tracked(5)));
+    ASSERT_TRUE(bst.emplace(1));
+    ASSERT_FALSE(bst.insert(Tracked(5)));
+    ASSERT_EQ(Tracked::copies, 0);
+    ASSERT_FALSE(bst.insert(Tracked(1)));
+    ASSERT_TRUE(bst.insert(three));
+    ASSERT_EQ(Tracked::copies, 1);
+    ASSERT_EQ(bst.size(), 3);
+    ASSERT_EQ(bst.begin()->key, 1);
+}
+
+TEST(BSTTests, MOVE_INSERT_STRING_TEST) {
+    BST<string> bst;
+    string name = "Meryl Streep";
+    string duplicate = "Meryl Streep";
+    ASSERT_TRUE(bst.insert(std::move(name)));
+    // assert a rejected move leaves the argument unchanged
+    ASSERT_FALSE(bst.insert(std::move(duplicate)));
+    ASSERT_EQ(duplicate, "Meryl Streep");
+    ASSERT_TRUE(bst.emplace(3, 'x'));
+    ASSERT_EQ(bst.inorder(), vector<string>({"Meryl Streep", "xxx"}));
+}
+
+TEST(BSTTests, DEREFERENCE_REFERENCE_TEST) {
+    BST<string> bst;
+    bst.insert("Kevin Bacon");
+    BST<string>::iterator it = bst.begin();
+    // assert dereferencing returns the stored item rather than a copy
+    ASSERT_EQ(&*it, &*bst.find("Kevin Bacon"));
+    ASSERT_EQ(it->size(), 11);
+}
+
+TEST(BSTTests, BATCH_CONTAINS_TEST) {
+    BST<int> bst;
+    vector<int> input{8, 3, 10, 1, 6, 14, 4, 7, 13};
+    insertIntoBST(input, bst);
+    // assert results come back in query order, duplicates included
+    vector<int> queries{7, 2, 14, 7, 0, 8, 15, 1, 13, 5};
+    vector<bool> expected{true, false, true,  true, false,
+                          true, false, true,  true, false};
+    ASSERT_EQ(bst.contains(queries), expected);
+    ASSERT_TRUE(bst.contains(vector<int>()).empty());
+}
+
+TEST(BSTTests, BATCH_CONTAINS_RANDOM_TEST) {
+    BST<int> bst;
+    set<int> expected;
+    mt19937 rng(5);
+    uniform_int_distribution<int> value(0, 3000);
+    for (int i = 0; i < 1000; i++) {
+        int item = value(rng);
+        bst.insert(item);
+        expected.insert(item);
+    }
+    vector<int> queries;
+    for (int i = 0; i < 2000; i++) {
+        queries.push_back(value(rng));
+    }
+    // assert the batch agrees with one find per query
+    vector<bool> found = bst.contains(queries);
+    ASSERT_EQ(found.size(), queries.size());
+    for (size_t i = 0; i < queries.size(); i++) {
+        ASSERT_EQ(found[i], expected.count(queries[i]) == 1);
+        ASSERT_EQ(found[i], bst.find(queries[i]) != bst.end());
+    }
+}
+
+TEST(BSTTests, BOUNDS_TEST) {
+    BST<int> bst;
+    vector<int> input{8, 3, 10, 1, 6, 14, 4, 7, 13};
+    insertIntoBST(input, bst);
+    // assert bounds of items in the tree, between items and past the ends
+    ASSERT_EQ(*bst.lower_bound(6), 6);
+    ASSERT_EQ(*bst.upper_bound(6), 7);
+    ASSERT_EQ(*bst.lower_bound(11), 13);
+    ASSERT_EQ(*bst.upper_bound(11), 13);
+    ASSERT_EQ(*bst.lower_bound(-5), 1);
+    ASSERT_EQ(bst.lower_bound(15), bst.end());
+    ASSERT_EQ(bst.upper_bound(14), bst.end());
+
+    auto found = bst.equal_range(10);
+    ASSERT_EQ(*found.first, 10);
+    ASSERT_EQ(*found.second, 13);
+    auto missing = bst.equal_range(5);
+    ASSERT_EQ(missing.first, missing.second);
+    ASSERT_EQ(*missing.first, 6);
+
+    BST<int> empty;
+    ASSERT_EQ(empty.lower_bound(1), empty.end());
+    ASSERT_EQ(empty.upper_bound(1), empty.end());
+}
+
+TEST(BSTTests, RANGE_SCAN_TEST) {
+    BST<int> bst;
+    set<int> expected;
+    mt19937 rng(11);
+    uniform_int_distribution<int> value(0, 1000);
+    for (int i = 0; i < 500; i++) {
+        int item = value(rng);
+        bst.insert(item);
+        expected.insert(item);
+    }
+    // assert every scan between two bounds matches std::set
+    for (int i = 0; i < 200; i++) {
+        int low = value(rng);
+        int high = low + value(rng) / 10;
+        vector<int> scanned(bst.lower_bound(low), bst.upper_bound(high));
+        vector<int> reference(expected.lower_bound(low),
+                              expected.upper_bound(high));
+        ASSERT_EQ(scanned, reference);
+    }
+}
+
+TEST(BSTTests, PREFIX_SCAN_TEST) {
+    BST<string> bst;
+    vector<string> names{"KEVIN BACON", "KEVIN COSTNER", "KEVIN HART",
+                         "KEANU REEVES", "KATE WINSLET", "KEVIN",
+                         "KEVINA", "LAURA DERN"};
+    insertIntoBST(names, bst);
+    // assert the names starting with a prefix are scanned in order, up to
+    // the first name that does not start with it
+    string prefix = "KEVIN ";
+    vector<string> scanned;
+    auto it = bst.lower_bound(prefix);
+    while (it != bst.end() && it->compare(0, prefix.size(), prefix) == 0) {
+        scanned.push_back(*it);
+        ++it;
+    }
+    ASSERT_EQ(scanned, vector<string>({"KEVIN BACON", "KEVIN COSTNER",
+                                       "KEVIN HART"}));
+}
+
+TEST(BSTTests, SELECT_RANK_TEST) {
+    BST<int, ThreeWayCompare<int>, true> bst;
+    vector<int> input{8, 3, 10, 1, 6, 14, 4, 7, 13};
+    insertIntoBST(input, bst);
+    vector<int> sorted = bst.inorder();
+    // assert select and rank invert each other on every position
+    for (unsigned int k = 0; k < sorted.size(); k++) {
+        ASSERT_EQ(*bst.select(k), sorted[k]);
+        ASSERT_EQ(bst.rank(sorted[k]), k);
+    }
+    ASSERT_EQ(bst.select(sorted.size()), bst.end());
+    // assert items not in the tree rank by what comes before them
+    ASSERT_EQ(bst.rank(0), 0);
+    ASSERT_EQ(bst.rank(5), 3);
+    ASSERT_EQ(bst.rank(100), 9);
+}
+
+TEST(BSTTests, SELECT_RANK_AFTER_ERASE_TEST) {
+    BST<int, ThreeWayCompare<int>, true> bst;
+    set<int> expected;
+    mt19937 rng(23);
+    uniform_int_distribution<int> value(0, 500);
+    for (int i = 0; i < 3000; i++) {
+        int item = value(rng);
+        if (i % 3 == 0) {
+            bst.erase(item);
+            expected.erase(item);
+        } else {
+            bst.insert(item);
+            expected.insert(item);
+        }
+    }
+    // assert counts stay right through relinked successors
+    unsigned int k = 0;
+    for (int item : expected) {
+        ASSERT_EQ(*bst.select(k), item);
+        ASSERT_EQ(bst.rank(item), k);
+        k++;
+    }
+    ASSERT_EQ(bst.select(k), bst.end());
+}
+
+TEST(BSTTests, SELECT_AFTER_BUILD_FROM_TEST) {
+    BST<string, ThreeWayCompare<string>, true> bst;
+    vector<string> names;
+    for (int i = 0; i < 1000; i++) {
+        names.push_back("actor " + to_string(1000 + i));
+    }
+    bst.buildFrom(names.begin(), names.end());
+    // assert the k-th name of a bulk loaded tree, as for pagination
+    ASSERT_EQ(*bst.select(0), "actor 1000");
+    ASSERT_EQ(*bst.select(250), "actor 1250");
+    ASSERT_EQ(bst.rank("actor 1500"), 500);
+    ASSERT_EQ(bst.rank("actor 1500x"), 501);
+}
@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "BTree.hpp"
+
+using namespace std;
+using namespace testing;
+
+TEST(BTreeTests, EMPTY_TREE_TEST) {
+    BTree<int> tree;
+    ASSERT_EQ(tree.height(), -1);
+    ASSERT_TRUE(tree.empty());
+    ASSERT_EQ(tree.find(3), tree.end());
+    ASSERT_EQ(tree.begin(), tree.end());
+    ASSERT_EQ(tree.inorder(), vector<int>{});
+}
+
+TEST(BTreeTests, SMALL_TREE_TEST) {
+    BTree<int> tree;
+    vector<int> input{3, 4, 1, 100, -33};
+    for (int item : input) {
+        ASSERT_TRUE(tree.insert(item));
+    }
+    // assert a few items fit in a single leaf
+    ASSERT_FALSE(tree.insert(3));
+    ASSERT_EQ(tree.size(), 5);
+    ASSERT_EQ(tree.height(), 0);
+    ASSERT_EQ(*tree.begin(), -33);
+    ASSERT_EQ(*tree.find(100), 100);
+    ASSERT_EQ(tree.find(0), tree.end());
+    ASSERT_EQ(tree.inorder(), vector<int>({-33, 1, 3, 4, 100}));
+}
+
+TEST(BTreeTests, SORTED_INSERT_TEST) {
+    BTree<int> tree;
+    for (int i = 0; i < 100000; i++) {
+        tree.insert(i);
+    }
+    // assert leaves split in half keep the tree shallow for sorted input
+    ASSERT_EQ(tree.size(), 100000);
+    ASSERT_LE(tree.height(), 5);
+    int expected = 0;
+    for (BTree<int>::iterator it = tree.begin(); it != tree.end(); it++) {
+        ASSERT_EQ(*it, expected++);
+    }
+    ASSERT_EQ(expected, 100000);
+}
+
+TEST(BTreeTests, RANDOM_INSERT_TEST) {
+    BTree<int> tree;
+    set<int> expected;
+    mt19937 rng(23);
+    uniform_int_distribution<int> value(0, 50000);
+    for (int i = 0; i < 100000; i++) {
+        int item = value(rng);
+        ASSERT_EQ(tree.insert(item), expected.insert(item).second);
+    }
+    ASSERT_EQ(tree.size(), expected.size());
+    ASSERT_TRUE(equal(tree.begin(), tree.end(), expected.begin()));
+    for (int i = 0; i <= 50000; i += 7) {
+        ASSERT_EQ(tree.find(i) != tree.end(), expected.count(i) == 1);
+    }
+}
+
+TEST(BTreeTests, STRING_TREE_TEST) {
+    BTree<string> tree;
+    set<string> expected;
+    for (int i = 0; i < 2000; i++) {
+        string name = "actor " + to_string((i * 7919) % 1500);
+        ASSERT_EQ(tree.insert(name), expected.insert(name).second);
+    }
+    // assert string items are found and destroyed with their nodes
+    ASSERT_EQ(*tree.find("actor 1499"), "actor 1499");
+    ASSERT_EQ(tree.find("actor 1499")->size(), 10);
+    ASSERT_EQ(tree.inorder(), vector<string>(expected.begin(), expected.end()));
+}
+
+TEST(BTreeTests, BOUNDS_TEST) {
+    BTree<int> btree;
+    set<int> expected;
+    for (int i = 0; i < 3000; i++) {
+        btree.insert(3 * i);
+        expected.insert(3 * i);
+    }
+    // assert bounds match std::set, across leaf boundaries and past the end
+    for (int item = -2; item < 9005; item++) {
+        auto lower = btree.lower_bound(item);
+        auto upper = btree.upper_bound(item);
+        if (expected.lower_bound(item) == expected.end()) {
+            ASSERT_EQ(lower, btree.end());
+        } else {
+            ASSERT_EQ(*lower, *expected.lower_bound(item));
+        }
+        if (expected.upper_bound(item) == expected.end()) {
+            ASSERT_EQ(upper, btree.end());
+        } else {
+            ASSERT_EQ(*upper, *expected.upper_bound(item));
+        }
+    }
+    auto range = btree.equal_range(300);
+    ASSERT_EQ(*range.first, 300);
+    ASSERT_EQ(*range.second, 303);
+    BTree<int> empty;
+    ASSERT_EQ(empty.lower_bound(0), empty.end());
+}
@@ -0,0 +1,82 @@
+#include <math.h>
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "ConcurrentBST.hpp"
+
+using namespace std;
+using namespace testing;
+
+TEST(ConcurrentBSTTests, EMPTY_TREE_TEST) {
+    ConcurrentBST<int> tree;
+    ASSERT_TRUE(tree.empty());
+    ASSERT_EQ(tree.height(), -1);
+    ASSERT_FALSE(tree.contains(3));
+}
+
+TEST(ConcurrentBSTTests, SINGLE_THREAD_TEST) {
+    ConcurrentBST<string> tree;
+    ASSERT_TRUE(tree.insert("Kevin Bacon"));
+    ASSERT_TRUE(tree.insert("Tom Hanks"));
+    ASSERT_FALSE(tree.insert("Kevin Bacon"));
+    string name = "Meryl Streep";
+    ASSERT_TRUE(tree.insert(std::move(name)));
+    ASSERT_EQ(tree.size(), 3);
+    ASSERT_TRUE(tree.contains("Tom Hanks"));
+    ASSERT_FALSE(tree.contains("Emma Stone"));
+}
+
+TEST(ConcurrentBSTTests, SORTED_INSERT_TEST) {
+    ConcurrentBST<int> tree;
+    for (int i = 0; i < 1023; i++) {
+        tree.insert(i);
+    }
+    // assert rotations keep sorted input balanced
+    ASSERT_EQ(tree.height(), 9);
+    for (int i = 0; i < 1023; i++) {
+        ASSERT_TRUE(tree.contains(i));
+    }
+    ASSERT_FALSE(tree.contains(1023));
+}
+
+TEST(ConcurrentBSTTests, READERS_DURING_INSERTS_TEST) {
+    const int NUM_ITEMS = 200000;
+    ConcurrentBST<int> tree;
+    // odd items are there from the start, even items are added meanwhile
+    for (int i = 1; i < NUM_ITEMS; i += 2) {
+        tree.insert(i);
+    }
+    atomic<bool> done(false);
+    atomic<int> wrong(0);
+    vector<thread> readers;
+    for (int r = 0; r < 4; r++) {
+        readers.emplace_back([&, r]() {
+            int item = r;
+            while (!done.load()) {
+                item = (item + 7919) % NUM_ITEMS;
+                // assert items present all along are always found, and
+                // items never inserted are never found
+                if (item % 2 == 1 && !tree.contains(item)) wrong++;
+                if (tree.contains(-item - 1)) wrong++;
+            }
+        });
+    }
+    for (int i = 0; i < NUM_ITEMS; i += 2) {
+        tree.insert(i);
+    }
+    done.store(true);
+    for (thread& reader : readers) {
+        reader.join();
+    }
+    ASSERT_EQ(wrong.load(), 0);
+    ASSERT_EQ(tree.size(), NUM_ITEMS);
+    ASSERT_LE(tree.height(), (int)(1.44 * log2(NUM_ITEMS + 2.0)));
+    for (int i = 0; i < NUM_ITEMS; i++) {
+        ASSERT_TRUE(tree.contains(i));
+    }
+}
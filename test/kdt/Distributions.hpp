@@ -0,0 +1,149 @@
+/**
+ * Random point generators used by the KD tree benchmarks. Every generator is
+ * seeded by the caller, so a benchmark run can be repeated exactly.
+ */
+
+#ifndef Distributions_hpp
+#define Distributions_hpp
+
+#include <random>
+#include <string>
+#include <vector>
+#include "Point.hpp"
+
+using namespace std;
+
+/** Returns numPoints uniformly random points in [0, 100]^numDim */
+inline vector<Point> uniformPoints(unsigned int numPoints, unsigned int numDim,
+                                   mt19937& rng) {
+    uniform_real_distribution<double> value(0, 100);
+    vector<Point> result;
+    result.reserve(numPoints);
+    for (unsigned int i = 0; i < numPoints; i++) {
+        vector<double> features(numDim);
+        for (double& f : features) f = value(rng);
+        result.push_back(Point(features));
+    }
+    return result;
+}
+
+/** Returns points in 16 round Gaussian clusters with standard deviation 1,
+ *  centered uniformly in [0, 100]^numDim.
+ */
+inline vector<Point> clusteredPoints(unsigned int numPoints,
+                                     unsigned int numDim, mt19937& rng) {
+    const unsigned int NUM_CLUSTERS = 16;
+    vector<Point> centers = uniformPoints(NUM_CLUSTERS, numDim, rng);
+    normal_distribution<double> noise(0, 1);
+    vector<Point> result;
+    result.reserve(numPoints);
+    for (unsigned int i = 0; i < numPoints; i++) {
+        vector<double> features = centers[i % NUM_CLUSTERS].features;
+        for (double& f : features) f += noise(rng);
+        result.push_back(Point(features));
+    }
+    return result;
+}
+
+/** Returns points in 8 long thin clusters: each cluster is a segment of
+ *  random direction and length up to 100, with noise of 0.1 around it.
+ */
+inline vector<Point> thinClusterPoints(unsigned int numPoints,
+                                       unsigned int numDim, mt19937& rng) {
+    const unsigned int NUM_CLUSTERS = 8;
+    uniform_real_distribution<double> position(0, 100), direction(-1, 1),
+        noise(-0.1, 0.1);
+    vector<vector<double>> starts(NUM_CLUSTERS), directions(NUM_CLUSTERS);
+    for (unsigned int c = 0; c < NUM_CLUSTERS; c++) {
+        for (unsigned int d = 0; d < numDim; d++) {
+            starts[c].push_back(position(rng));
+            directions[c].push_back(direction(rng));
+        }
+    }
+
+    vector<Point> result;
+    result.reserve(numPoints);
+    for (unsigned int i = 0; i < numPoints; i++) {
+        unsigned int c = i % NUM_CLUSTERS;
+        double t = position(rng);
+        vector<double> features(numDim);
+        for (unsigned int d = 0; d < numDim; d++) {
+            features[d] = starts[c][d] + t * directions[c][d] + noise(rng);
+        }
+        result.push_back(Point(features));
+    }
+    return result;
+}
+
+/** Returns points where the first dimension spans [0, 1000] and every other
+ *  dimension spans [0, 1].
+ */
+inline vector<Point> stretchedPoints(unsigned int numPoints,
+                                     unsigned int numDim, mt19937& rng) {
+    uniform_real_distribution<double> wide(0, 1000), narrow(0, 1);
+    vector<Point> result;
+    result.reserve(numPoints);
+    for (unsigned int i = 0; i < numPoints; i++) {
+        vector<double> features(numDim);
+        features[0] = wide(rng);
+        for (unsigned int d = 1; d < numDim; d++) features[d] = narrow(rng);
+        result.push_back(Point(features));
+    }
+    return result;
+}
+
+/** Returns points exactly on one line through [0, 100]^numDim */
+inline vector<Point> linePoints(unsigned int numPoints, unsigned int numDim,
+                                mt19937& rng) {
+    vector<Point> ends = uniformPoints(2, numDim, rng);
+    uniform_real_distribution<double> position(0, 1);
+    vector<Point> result;
+    result.reserve(numPoints);
+    for (unsigned int i = 0; i < numPoints; i++) {
+        double t = position(rng);
+        vector<double> features(numDim);
+        for (unsigned int d = 0; d < numDim; d++) {
+            features[d] = ends[0].features[d] +
+                          t * (ends[1].features[d] - ends[0].features[d]);
+        }
+        result.push_back(Point(features));
+    }
+    return result;
+}
+
+/** Returns points drawn from only numPoints / 100 distinct locations */
+inline vector<Point> duplicatePoints(unsigned int numPoints,
+                                     unsigned int numDim, mt19937& rng) {
+    unsigned int numDistinct = numPoints / 100 + 1;
+    vector<Point> distinct = uniformPoints(numDistinct, numDim, rng);
+    uniform_int_distribution<unsigned int> pick(0, numDistinct - 1);
+    vector<Point> result;
+    result.reserve(numPoints);
+    for (unsigned int i = 0; i < numPoints; i++) {
+        result.push_back(distinct[pick(rng)]);
+    }
+    return result;
+}
+
+/** Returns points from the named distribution: uniform, clustered, thin,
+ *  stretched, line or duplicates. Returns an empty vector for any other name.
+ */
+inline vector<Point> generatePoints(const string& distribution,
+                                    unsigned int numPoints,
+                                    unsigned int numDim, mt19937& rng) {
+    if (distribution == "uniform") return uniformPoints(numPoints, numDim, rng);
+    if (distribution == "clustered") {
+        return clusteredPoints(numPoints, numDim, rng);
+    }
+    if (distribution == "thin") return thinClusterPoints(numPoints, numDim, rng);
+    if (distribution == "stretched") {
+        return stretchedPoints(numPoints, numDim, rng);
+    }
+    if (distribution == "line") return linePoints(numPoints, numDim, rng);
+    if (distribution == "duplicates") {
+        return duplicatePoints(numPoints, numDim, rng);
+    }
+    return vector<Point>();
+}
+
+#endif /* Distributions_hpp */
@@ -7,12 +7,15 @@
 
 #include <algorithm>
 #include <vector>
+#include "Metric.hpp"
 #include "Point.hpp"
 
-class NaiveSearch {
+template <class Metric = SquaredEuclidean>
+class BasicNaiveSearch {
   private:
     vector<Point> points;
     Point nearestNeighbor;
+    Metric metric;
 
     /** Check if the given point is contained in regionQuery */
     bool isContained(Point& point, vector<pair<double, double>>& regionQuery) {
@@ -26,7 +29,7 @@ class NaiveSearch {
     }
 
   public:
-    NaiveSearch() {}
+    BasicNaiveSearch(const Metric& metric = Metric()) : metric(metric) {}
 
     /** Initialize the data points */
     void build(vector<Point>& points) { this->points = points; }
@@ -35,13 +38,13 @@ class NaiveSearch {
     Point* findNearestNeighbor(Point& queryPoint) {
         if (points.size() == 0) return nullptr;
 
-        points[0].setDistToQuery(queryPoint);
+        points[0].setDistToQuery(queryPoint, metric);
         double minDist = points[0].distToQuery;
         nearestNeighbor = points[0];
 
         // simply find the point with min distToQuery
         for (Point& point : points) {
-            point.setDistToQuery(queryPoint);
+            point.setDistToQuery(queryPoint, metric);
             if (point.distToQuery < minDist) {
                 minDist = point.distToQuery;
                 nearestNeighbor = point;
@@ -63,4 +66,6 @@ class NaiveSearch {
     }
 };
 
+typedef BasicNaiveSearch<SquaredEuclidean> NaiveSearch;
+
 #endif /* NaiveSearch_hpp */
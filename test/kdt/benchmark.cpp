@@ -0,0 +1,478 @@
+/**
+ * Benchmark suite for the nearest neighbor and range search engines. Sweeps
+ * every combination of the given build sizes, dimensions, query counts, data
+ * distributions, engines and split rules, and reports build time, query
+ * throughput and latency percentiles as JSON or CSV.
+ *
+ * Usage: ./benchmark [--n=LIST] [--dim=LIST] [--queries=LIST] [--dist=LIST]
+ *                    [--engine=LIST] [--split=LIST] [--range=LENGTH]
+ *                    [--repeats=R] [--warmup=W] [--seed=S]
+ *                    [--format=json|csv]
+ *
+ * LIST is comma separated, e.g. --n=10000,100000 --dist=uniform,line.
+ *   dist:   uniform, clustered, thin, stretched, line, duplicates
+ *   engine: kdt, kdt-parallel (parallel range search), kdt-lazy (subtrees
+ *           built on first search), naive, brute, auto (brute force or KD
+ *           tree, picked by calibration), vp, grid, disk (leaf pages
+ *           in a file in the working directory)
+ *   split:  cycle, max_spread, sliding_midpoint, surface_area (kdt only)
+ * Each configuration is built and queried warmup + repeats times; only the
+ * last repeats runs are measured. Results go to stdout, progress to stderr.
+ */
+
+#include <stdlib.h>
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "AutoIndex.hpp"
+#include "BruteForce.hpp"
+#include "DiskKDT.hpp"
+#include "Distributions.hpp"
+#include "GridIndex.hpp"
+#include "KDT.hpp"
+#include "NaiveSearch.hpp"
+#include "Point.hpp"
+#include "Timer.hpp"
+#include "VPTree.hpp"
+
+using namespace std;
+
+/** Command line options of the benchmark */
+struct Options {
+    vector<string> sizes{"10000", "100000", "1000000"};
+    vector<string> dims{"2", "3", "8"};
+    vector<string> queries{"1000"};
+    vector<string> dists{"uniform", "clustered", "line", "duplicates"};
+    vector<string> engines{"kdt", "brute", "auto"};
+    vector<string> splits{"cycle"};
+    double rangeLength = 5;
+    unsigned int repeats = 3;
+    unsigned int warmup = 1;
+    unsigned int seed = 1;
+    string format = "json";
+};
+
+/** One configuration of the sweep */
+struct Config {
+    unsigned int size;
+    unsigned int dim;
+    unsigned int numQueries;
+    string dist;
+    string engine;
+    string split;
+};
+
+/** Timings collected over the measured repeats of one configuration */
+struct Measurement {
+    vector<long long> buildNs;
+    vector<long long> nnNs;
+    vector<long long> rangeNs;
+    unsigned long long rangeHits = 0;
+};
+
+/** Splits a comma separated list */
+vector<string> splitList(const string& list) {
+    vector<string> result;
+    stringstream stream(list);
+    string item;
+    while (getline(stream, item, ',')) {
+        if (!item.empty()) result.push_back(item);
+    }
+    return result;
+}
+
+/** Converts a split rule name to a SplitRule. Returns false if unknown. */
+bool parseSplitRule(const string& name, SplitRule& rule) {
+    if (name == "cycle") {
+        rule = CYCLE;
+    } else if (name == "max_spread") {
+        rule = MAX_SPREAD;
+    } else if (name == "sliding_midpoint") {
+        rule = SLIDING_MIDPOINT;
+    } else if (name == "surface_area") {
+        rule = SURFACE_AREA;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/** Returns true if name is one of the given names */
+bool isOneOf(const string& name, const vector<string>& names) {
+    return find(names.begin(), names.end(), name) != names.end();
+}
+
+/** Parses the command line into options. Returns false on a bad argument
+ *  or an unknown distribution, engine or split rule. */
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        size_t eq = arg.find('=');
+        if (arg.compare(0, 2, "--") != 0 || eq == string::npos) {
+            cerr << "Invalid argument: " << arg << endl;
+            return false;
+        }
+        string key = arg.substr(2, eq - 2);
+        string value = arg.substr(eq + 1);
+        if (key == "n") {
+            options.sizes = splitList(value);
+        } else if (key == "dim") {
+            options.dims = splitList(value);
+        } else if (key == "queries") {
+            options.queries = splitList(value);
+        } else if (key == "dist") {
+            options.dists = splitList(value);
+        } else if (key == "engine") {
+            options.engines = splitList(value);
+        } else if (key == "split") {
+            options.splits = splitList(value);
+        } else if (key == "range") {
+            options.rangeLength = atof(value.c_str());
+        } else if (key == "repeats") {
+            options.repeats = max(1, atoi(value.c_str()));
+        } else if (key == "warmup") {
+            options.warmup = max(0, atoi(value.c_str()));
+        } else if (key == "seed") {
+            options.seed = atoi(value.c_str());
+        } else if (key == "format" && (value == "json" || value == "csv")) {
+            options.format = value;
+        } else {
+            cerr << "Invalid argument: " << arg << endl;
+            return false;
+        }
+    }
+
+    // reject unknown names before any output, so a bad list never leaves
+    // a half written document on stdout
+    for (const string& dist : options.dists) {
+        if (!isOneOf(dist, {"uniform", "clustered", "thin", "stretched",
+                            "line", "duplicates"})) {
+            cerr << "Unknown distribution: " << dist << endl;
+            return false;
+        }
+    }
+    for (const string& engine : options.engines) {
+        if (!isOneOf(engine, {"kdt", "kdt-parallel", "kdt-lazy", "naive",
+                              "brute", "auto", "vp", "grid", "disk"})) {
+            cerr << "Unknown engine: " << engine << endl;
+            return false;
+        }
+    }
+    for (const string& split : options.splits) {
+        SplitRule rule;
+        if (!parseSplitRule(split, rule)) {
+            cerr << "Unknown split rule: " << split << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Builds an index with makeIndex and runs every query against it,
+ *  warmup + repeats times, recording the timings of the measured runs.
+ *  @param makeIndex Returns a built index for the given points, or nullptr
+ *                   if it could not be built
+ *  @param rangeSearch Runs a range search on the index
+ *  @return false if an index could not be built
+ */
+template <class MakeIndex, class RangeSearch>
+bool measure(MakeIndex makeIndex, RangeSearch rangeSearch,
+             const Options& options, const vector<Point>& data,
+             vector<Point>& queries,
+             vector<vector<pair<double, double>>>& regions,
+             Measurement& result) {
+    Timer t;
+    for (unsigned int run = 0; run < options.warmup + options.repeats;
+         run++) {
+        bool measured = run >= options.warmup;
+
+        // some engines reorder their input, so build from a fresh copy
+        vector<Point> buildData = data;
+        t.begin_timer();
+        auto index = makeIndex(buildData);
+        long long buildTime = t.end_timer();
+        if (!index) return false;
+        if (measured) result.buildNs.push_back(buildTime);
+
+        for (Point& query : queries) {
+            t.begin_timer();
+            index->findNearestNeighbor(query);
+            long long time = t.end_timer();
+            if (measured) result.nnNs.push_back(time);
+        }
+        for (vector<pair<double, double>>& region : regions) {
+            t.begin_timer();
+            size_t hits = rangeSearch(*index, region).size();
+            long long time = t.end_timer();
+            if (measured) {
+                result.rangeNs.push_back(time);
+                result.rangeHits += hits;
+            }
+        }
+    }
+    return true;
+}
+
+/** Runs one configuration. Returns false if its engine or rule is unknown
+ *  or its index could not be built. */
+bool runConfig(const Config& config, const Options& options,
+               const vector<Point>& data, vector<Point>& queries,
+               vector<vector<pair<double, double>>>& regions,
+               Measurement& result) {
+    SplitRule rule = CYCLE;
+    if (!parseSplitRule(config.split, rule)) return false;
+
+    if (config.engine == "kdt" || config.engine == "kdt-parallel" ||
+        config.engine == "kdt-lazy") {
+        bool parallel = config.engine == "kdt-parallel";
+        bool lazy = config.engine == "kdt-lazy";
+        measure(
+            [&](vector<Point>& points) {
+                unique_ptr<KDT> index(new KDT());
+                index->setSplitRule(rule);
+                index->setLazyBuild(lazy);
+                index->build(points);
+                return index;
+            },
+            [&](KDT& index, vector<pair<double, double>>& region) {
+                return parallel ? index.parallelRangeSearch(region)
+                                : index.rangeSearch(region);
+            },
+            options, data, queries, regions, result);
+    } else if (config.engine == "naive") {
+        measure(
+            [&](vector<Point>& points) {
+                unique_ptr<NaiveSearch> index(new NaiveSearch());
+                index->build(points);
+                return index;
+            },
+            [&](NaiveSearch& index, vector<pair<double, double>>& region) {
+                return index.rangeSearch(region);
+            },
+            options, data, queries, regions, result);
+    } else if (config.engine == "brute") {
+        measure(
+            [&](vector<Point>& points) {
+                unique_ptr<BruteForce> index(new BruteForce());
+                index->build(points);
+                return index;
+            },
+            [&](BruteForce& index, vector<pair<double, double>>& region) {
+                return index.rangeSearch(region);
+            },
+            options, data, queries, regions, result);
+    } else if (config.engine == "auto") {
+        measure(
+            [&](vector<Point>& points) {
+                unique_ptr<AutoIndex> index(new AutoIndex());
+                index->build(points);
+                return index;
+            },
+            [&](AutoIndex& index, vector<pair<double, double>>& region) {
+                return index.rangeSearch(region);
+            },
+            options, data, queries, regions, result);
+    } else if (config.engine == "vp") {
+        measure(
+            [&](vector<Point>& points) {
+                unique_ptr<VPTree> index(new VPTree());
+                index->build(points);
+                return index;
+            },
+            [&](VPTree& index, vector<pair<double, double>>& region) {
+                return index.rangeSearch(region);
+            },
+            options, data, queries, regions, result);
+    } else if (config.engine == "disk") {
+        bool built = measure(
+            [&](vector<Point>& points) {
+                unique_ptr<DiskKDT> index(new DiskKDT());
+                if (!index->build(points, "benchmark.index")) index.reset();
+                return index;
+            },
+            [&](DiskKDT& index, vector<pair<double, double>>& region) {
+                return index.rangeSearch(region);
+            },
+            options, data, queries, regions, result);
+        bool removed = remove("benchmark.index") == 0;
+        if (!built || !removed) {
+            cerr << "Cannot write benchmark.index in the working directory"
+                 << endl;
+            return false;
+        }
+    } else if (config.engine == "grid") {
+        measure(
+            [&](vector<Point>& points) {
+                unique_ptr<GridIndex> index(new GridIndex());
+                index->build(points);
+                return index;
+            },
+            [&](GridIndex& index, vector<pair<double, double>>& region) {
+                return index.rangeSearch(region);
+            },
+            options, data, queries, regions, result);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/** Returns the p-th percentile (0 to 1) of the sorted values */
+long long percentile(const vector<long long>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    return sorted[(size_t)(p * (sorted.size() - 1) + 0.5)];
+}
+
+/** Returns the number of operations per second over all given timings */
+double throughput(const vector<long long>& times) {
+    long long total = 0;
+    for (long long time : times) total += time;
+    return total == 0 ? 0 : times.size() * 1e9 / total;
+}
+
+/** Summary statistics of one list of timings, in output order */
+vector<pair<string, double>> summarize(const string& prefix,
+                                       vector<long long> times) {
+    sort(times.begin(), times.end());
+    return {make_pair(prefix + "_per_sec", throughput(times)),
+            make_pair(prefix + "_p50_ns", (double)percentile(times, 0.5)),
+            make_pair(prefix + "_p90_ns", (double)percentile(times, 0.9)),
+            make_pair(prefix + "_p99_ns", (double)percentile(times, 0.99)),
+            make_pair(prefix + "_max_ns", (double)percentile(times, 1))};
+}
+
+/** Prints one result as a JSON object or CSV row */
+void printResult(const Config& config, const Options& options,
+                 Measurement& result, bool first) {
+    vector<pair<string, string>> labels{
+        make_pair("engine", config.engine), make_pair("split", config.split),
+        make_pair("dist", config.dist)};
+    vector<pair<string, double>> values{
+        make_pair("n", (double)config.size),
+        make_pair("dim", (double)config.dim),
+        make_pair("queries", (double)config.numQueries),
+        make_pair("repeats", (double)options.repeats)};
+    vector<long long> builds = result.buildNs;
+    sort(builds.begin(), builds.end());
+    values.push_back(
+        make_pair("build_ms_median", percentile(builds, 0.5) / 1e6));
+    for (auto& value : summarize("nn", result.nnNs)) values.push_back(value);
+    for (auto& value : summarize("range", result.rangeNs)) {
+        values.push_back(value);
+    }
+    values.push_back(make_pair(
+        "range_hits_avg",
+        result.rangeNs.empty()
+            ? 0
+            : (double)result.rangeHits / result.rangeNs.size()));
+
+    if (options.format == "csv") {
+        if (first) {
+            for (auto& label : labels) cout << label.first << ",";
+            for (size_t i = 0; i < values.size(); i++) {
+                cout << values[i].first
+                     << (i + 1 < values.size() ? "," : "\n");
+            }
+        }
+        for (auto& label : labels) cout << label.second << ",";
+        for (size_t i = 0; i < values.size(); i++) {
+            cout << values[i].second << (i + 1 < values.size() ? "," : "\n");
+        }
+    } else {
+        cout << (first ? "[\n" : ",\n") << "  {";
+        for (auto& label : labels) {
+            cout << "\"" << label.first << "\": \"" << label.second << "\", ";
+        }
+        for (size_t i = 0; i < values.size(); i++) {
+            cout << "\"" << values[i].first << "\": " << values[i].second
+                 << (i + 1 < values.size() ? ", " : "}");
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        cerr << "Usage: ./benchmark [--n=LIST] [--dim=LIST] [--queries=LIST] "
+                "[--dist=LIST] [--engine=LIST] [--split=LIST] "
+                "[--range=LENGTH] [--repeats=R] [--warmup=W] [--seed=S] "
+                "[--format=json|csv]"
+             << endl;
+        return -1;
+    }
+
+    bool first = true;
+    for (const string& size : options.sizes) {
+        for (const string& dim : options.dims) {
+            for (const string& numQueries : options.queries) {
+                for (const string& dist : options.dists) {
+                    Config config;
+                    config.size = atoi(size.c_str());
+                    config.dim = max(1, atoi(dim.c_str()));
+                    config.numQueries = atoi(numQueries.c_str());
+                    config.dist = dist;
+
+                    // queries come from the same distribution as the data;
+                    // each range query is a box of side rangeLength around
+                    // one of them
+                    mt19937 rng(options.seed);
+                    vector<Point> data = generatePoints(
+                        dist, config.size + config.numQueries, config.dim,
+                        rng);
+                    vector<Point> queries(data.end() - config.numQueries,
+                                          data.end());
+                    data.resize(config.size);
+                    vector<vector<pair<double, double>>> regions;
+                    for (Point& query : queries) {
+                        vector<pair<double, double>> region;
+                        for (double f : query.features) {
+                            region.push_back(
+                                make_pair(f - options.rangeLength / 2,
+                                          f + options.rangeLength / 2));
+                        }
+                        regions.push_back(region);
+                    }
+
+                    for (const string& engine : options.engines) {
+                        // split rules only apply to the KD tree engines
+                        vector<string> splits = options.splits;
+                        if (engine.compare(0, 3, "kdt") != 0) {
+                            splits = {"cycle"};
+                        }
+                        for (const string& split : splits) {
+                            config.engine = engine;
+                            config.split = split;
+                            cerr << "Running " << engine << " (" << split
+                                 << ") n=" << config.size
+                                 << " dim=" << config.dim
+                                 << " queries=" << config.numQueries
+                                 << " dist=" << dist << endl;
+                            Measurement result;
+                            if (!runConfig(config, options, data, queries,
+                                           regions, result)) {
+                                cerr << "Failed to run engine: " << engine
+                                     << ", " << split << endl;
+                                // keep what was written a complete document
+                                if (options.format == "json" && !first) {
+                                    cout << "\n]\n";
+                                }
+                                return -1;
+                            }
+                            printResult(config, options, result, first);
+                            first = false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    if (options.format == "json") {
+        cout << (first ? "[]\n" : "\n]\n");
+    }
+    return 0;
+}
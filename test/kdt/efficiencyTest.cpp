@@ -10,7 +10,9 @@
 #include "KDT.hpp"
 #include "NaiveSearch.hpp"
 #include "Point.hpp"
+#include "SearchStats.hpp"
 #include "Timer.hpp"
+#include "VPTree.hpp"
 
 /** Return a random number between min and max. Note that rand() returns
  *  bad random numbers, but for simplicity, we use it to serve our purpose
@@ -60,9 +62,12 @@ int main() {
     const double MIN_VAL = 0;      // lower bound of random data features
     const double MAX_VAL = 100;    // upper bound of random data features
     const double RANGE_LEN = 3;    // length of random range (EC)
+    const double LARGE_RANGE_LEN = 50;  // length of large random range (EC)
+    const int NUM_BATCH_TEST = 100000;  // number of batched queries
 
     KDT kdtree;
     NaiveSearch naiveSearch;
+    VPTree vptree;
 
     cout << endl << "Build points size: " << NUM_DATA << endl;
     cout << "Number of dimension: " << NUM_DIM << endl;
@@ -75,6 +80,7 @@ int main() {
 
     kdtree.build(buildData);
     naiveSearch.build(buildData);
+    vptree.build(buildData);
 
     Timer t;
     long long sumTime = 0;
@@ -84,9 +90,19 @@ int main() {
 
     cout << "\tTiming KD tree..." << endl;
 
+    StatsHistogram nnHistogram;
     t.begin_timer();
     for (Point& p : testData) {
         kdtree.findNearestNeighbor(p);
+        KDT_STAT(nnHistogram.add(kdtree.lastSearchStats()));
+    }
+    sumTime = t.end_timer();
+    cout << "\tTime taken: " << sumTime << " nanoseconds\n" << endl;
+
+    cout << "\tTiming VP tree..." << endl;
+    t.begin_timer();
+    for (Point& p : testData) {
+        vptree.findNearestNeighbor(p);
     }
     sumTime = t.end_timer();
     cout << "\tTime taken: " << sumTime << " nanoseconds\n" << endl;
@@ -109,9 +125,19 @@ int main() {
     }
 
     cout << "\tTiming KD tree..." << endl;
+    StatsHistogram rangeHistogram;
     t.begin_timer();
     for (vector<pair<double, double>>& range : ranges) {
         kdtree.rangeSearch(range);
+        KDT_STAT(rangeHistogram.add(kdtree.lastSearchStats()));
+    }
+    sumTime = t.end_timer();
+    cout << "\tTime taken: " << sumTime << " nanoseconds\n" << endl;
+
+    cout << "\tTiming VP tree..." << endl;
+    t.begin_timer();
+    for (vector<pair<double, double>>& range : ranges) {
+        vptree.rangeSearch(range);
     }
     sumTime = t.end_timer();
     cout << "\tTime taken: " << sumTime << " nanoseconds\n" << endl;
@@ -124,5 +150,83 @@ int main() {
     sumTime = t.end_timer();
     cout << "\tTime taken: " << sumTime << " nanoseconds\n" << endl;
 
+    cout << "Test 3: large range search, serial vs parallel (EC)" << endl
+         << endl;
+    cout << "\tQuery range size: " << NUM_TEST
+         << "; Range length of each dimension: " << LARGE_RANGE_LEN << ";"
+         << endl
+         << endl;
+    ranges.clear();
+    for (int i = 0; i < NUM_TEST; i++) {
+        ranges.push_back(
+            rangeRange(NUM_DIM, LARGE_RANGE_LEN, MIN_VAL, MAX_VAL));
+    }
+
+    cout << "\tTiming KD tree..." << endl;
+    t.begin_timer();
+    for (vector<pair<double, double>>& range : ranges) {
+        kdtree.rangeSearch(range);
+    }
+    sumTime = t.end_timer();
+    cout << "\tTime taken: " << sumTime << " nanoseconds\n" << endl;
+
+    cout << "\tTiming parallel KD tree ("
+         << thread::hardware_concurrency() << " threads)..." << endl;
+    t.begin_timer();
+    for (vector<pair<double, double>>& range : ranges) {
+        kdtree.parallelRangeSearch(range);
+    }
+    sumTime = t.end_timer();
+    cout << "\tTime taken: " << sumTime << " nanoseconds\n" << endl;
+
+    cout << "Test 4: batched nearest neighbor search" << endl << endl;
+    cout << "\tQuery points size: " << NUM_BATCH_TEST << ";" << endl << endl;
+    vector<Point> batchData =
+        randomPoints(NUM_BATCH_TEST, NUM_DIM, MIN_VAL, MAX_VAL);
+
+    cout << "\tTiming KD tree, one query at a time..." << endl;
+    t.begin_timer();
+    for (Point& p : batchData) {
+        kdtree.findNearestNeighbor(p);
+    }
+    sumTime = t.end_timer();
+    cout << "\tTime taken: " << sumTime << " nanoseconds\n" << endl;
+
+    for (unsigned int groupSize : {8, 16, 32}) {
+        cout << "\tTiming KD tree, " << groupSize
+             << " interleaved queries..." << endl;
+        t.begin_timer();
+        kdtree.findNearestNeighbors(batchData, groupSize);
+        sumTime = t.end_timer();
+        cout << "\tTime taken: " << sumTime << " nanoseconds\n" << endl;
+    }
+
+    cout << "Test 5: nearest neighbor search with a node budget" << endl
+         << endl;
+    cout << "\tQuery points size: " << NUM_BATCH_TEST << ";" << endl << endl;
+    for (unsigned long long maxNodes : {16, 64, 256}) {
+        cout << "\tTiming KD tree, at most " << maxNodes << " nodes..."
+             << endl;
+        SearchBudget budget;
+        budget.maxNodes = maxNodes;
+        int numExact = 0;
+        t.begin_timer();
+        for (Point& p : batchData) {
+            bool exact = false;
+            kdtree.findNearestNeighbor(p, budget, exact);
+            numExact += exact;
+        }
+        sumTime = t.end_timer();
+        cout << "\tTime taken: " << sumTime << " nanoseconds" << endl;
+        cout << "\tProven exact: " << numExact << " of " << NUM_BATCH_TEST
+             << "\n" << endl;
+    }
+
+    // search statistics are only collected when built with kdt_stats=true
+    if (SearchStats::enabled) {
+        nnHistogram.print(cout, "KD tree nearest neighbor search statistics");
+        rangeHistogram.print(cout, "KD tree range search statistics");
+    }
+
     return 0;
 }
\ No newline at end of file
@@ -1,7 +1,8 @@
 /**
  * This program takes in two files: build data file and query data file.
  * For each query data, this program outputs its nearest neighbor in the
- * build data. The nearest neighbor searching is achieved using KD tree.
+ * build data. The nearest neighbor searching is achieved using KD tree, or
+ * with the index named by an optional third argument (kdt, grid or vp).
  */
 
 #include <algorithm>
@@ -10,8 +11,11 @@
 #include <sstream>
 #include <string>
 #include <vector>
+#include "GridIndex.hpp"
 #include "KDT.hpp"
 #include "Point.hpp"
+#include "SearchStats.hpp"
+#include "VPTree.hpp"
 
 using namespace std;
 
@@ -75,13 +79,29 @@ vector<Point> readPoints(const char* fileName) {
     return result;
 }
 
+/** Prints the nearest neighbor in index of each query point */
+template <class Index>
+void printNearestNeighbors(Index& index, vector<Point>& queryPoints) {
+    cout << "Nearest neighbor of each query point: " << endl;
+    for (Point& query : queryPoints) {
+        cout << *index.findNearestNeighbor(query) << endl;
+    }
+}
+
 int main(int argc, char* argv[]) {
-    const int NUM_ARG = 3;
+    const int MIN_ARG = 3;
+    const int MAX_ARG = 4;
 
     // check for Arguments
-    if (argc != NUM_ARG) {
+    if (argc < MIN_ARG || argc > MAX_ARG) {
         cout << "Invalid number of arguments.\n"
              << "Usage: ./main <build data filename> <query data filename>"
+             << " [kdt|grid|vp]" << endl;
+        return -1;
+    }
+    string engine = argc == MAX_ARG ? argv[3] : "kdt";
+    if (engine != "kdt" && engine != "grid" && engine != "vp") {
+        cout << "Unknown index " << engine << ". Use kdt, grid or vp."
              << endl;
         return -1;
     }
@@ -89,17 +109,41 @@ int main(int argc, char* argv[]) {
     // check for valid file
     if (!fileValid(argv[1]) || !fileValid(argv[2])) return -1;
 
-    KDT tree;
     vector<Point> buildPoints = readPoints(argv[1]);
     vector<Point> queryPoints = readPoints(argv[2]);
 
+    if (engine == "grid") {
+        GridIndex grid;
+        grid.build(buildPoints);
+        cout << "Size of grid index: " << grid.size() << endl;
+        cout << "Cells in grid index: " << grid.numCells() << endl;
+        printNearestNeighbors(grid, queryPoints);
+        return 0;
+    }
+    if (engine == "vp") {
+        VPTree vptree;
+        vptree.build(buildPoints);
+        cout << "Size of VP tree: " << vptree.size() << endl;
+        cout << "Height of VP tree: " << vptree.height() << endl;
+        printNearestNeighbors(vptree, queryPoints);
+        return 0;
+    }
+
+    KDT tree;
     tree.build(buildPoints);
 
     cout << "Size of KD tree: " << tree.size() << endl;
     cout << "Height of KD tree: " << tree.height() << endl;
     cout << "Nearest neighbor of each query point: " << endl;
+    StatsHistogram histogram;
     for (Point& query : queryPoints) {
         cout << *tree.findNearestNeighbor(query) << endl;
+        KDT_STAT(histogram.add(tree.lastSearchStats()));
+    }
+
+    // search statistics are only collected when built with kdt_stats=true
+    if (SearchStats::enabled) {
+        histogram.print(cout, "Nearest neighbor search statistics");
     }
 
     return 0;
@@ -0,0 +1,95 @@
+/**
+ * Compare KD tree split rules on uniform and skewed data by counting how many
+ * nodes each nearest neighbor search visits.
+ *
+ * Usage: ./splitBenchmark [number of build points] [number of queries]
+ */
+
+#include <stdlib.h>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Distributions.hpp"
+#include "KDT.hpp"
+#include "Point.hpp"
+#include "Timer.hpp"
+
+using namespace std;
+
+/** Squared Euclidean metric that counts its distance evaluations. The KD tree
+ *  evaluates one distance per visited node, so this counts node visits.
+ */
+struct CountingMetric : public SquaredEuclidean {
+    long long* count;
+
+    CountingMetric(long long* count) : count(count) {}
+
+    inline double operator()(const double* a, const double* b,
+                             unsigned int numDim) const {
+        ++*count;
+        return SquaredEuclidean::operator()(a, b, numDim);
+    }
+};
+
+/** Builds a KD tree with the given rule and prints build time and the
+ *  average number of nodes visited per nearest neighbor query.
+ */
+void runRule(const string& ruleName, SplitRule rule, vector<Point>& buildData,
+             vector<Point>& queries) {
+    long long visits = 0;
+    BasicKDT<CountingMetric> kdtree((CountingMetric(&visits)));
+    kdtree.setSplitRule(rule);
+
+    Timer t;
+    t.begin_timer();
+    kdtree.build(buildData);
+    long long buildTime = t.end_timer();
+
+    t.begin_timer();
+    for (Point& query : queries) {
+        kdtree.findNearestNeighbor(query);
+    }
+    long long queryTime = t.end_timer();
+
+    cout << "\t" << ruleName << ": height " << kdtree.height()
+         << "; build " << buildTime / 1000000 << " ms; "
+         << (double)visits / queries.size() << " visits/query; "
+         << queryTime / queries.size() << " ns/query" << endl;
+}
+
+/** Runs every split rule against the given data set */
+void runDataSet(const string& name, vector<Point> buildData,
+                vector<Point>& queries) {
+    cout << name << ":" << endl;
+    runRule("CYCLE", CYCLE, buildData, queries);
+    runRule("MAX_SPREAD", MAX_SPREAD, buildData, queries);
+    runRule("SLIDING_MIDPOINT", SLIDING_MIDPOINT, buildData, queries);
+    runRule("SURFACE_AREA", SURFACE_AREA, buildData, queries);
+    cout << endl;
+}
+
+int main(int argc, char* argv[]) {
+    unsigned int numData = argc > 1 ? atoi(argv[1]) : 200000;
+    unsigned int numTest = argc > 2 ? atoi(argv[2]) : 1000;
+    const unsigned int NUM_DIM = 3;
+
+    cout << "Build points size: " << numData << endl;
+    cout << "Query points size: " << numTest << endl;
+    cout << "Number of dimension: " << NUM_DIM << endl << endl;
+
+    mt19937 rng(1);
+    // queries are drawn from the data distribution itself, so each query
+    // lands in the populated part of the space
+    const vector<string> distributions{"uniform", "thin", "stretched"};
+    for (const string& distribution : distributions) {
+        vector<Point> data =
+            generatePoints(distribution, numData + numTest, NUM_DIM, rng);
+        vector<Point> queries(data.end() - numTest, data.end());
+        data.resize(numData);
+        runDataSet(distribution, data, queries);
+    }
+
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "AutoIndex.hpp"
+#include "BruteForce.hpp"
+#include "Distributions.hpp"
+#include "NaiveSearch.hpp"
+#include "Point.hpp"
+#include "util.hpp"
+
+using namespace std;
+using namespace testing;
+
+/** Orders points by their features so results can be compared as sets */
+bool lessFeatures(const Point& p1, const Point& p2) {
+    return p1.features < p2.features;
+}
+
+TEST(BruteForceTests, TEST_EMPTY) {
+    BruteForce bruteForce;
+    vector<Point> vec;
+    bruteForce.build(vec);
+    Point queryPoint({5.81, 3.21});
+    // Assert searching an empty engine finds nothing
+    ASSERT_EQ(bruteForce.findNearestNeighbor(queryPoint), nullptr);
+    ASSERT_EQ(bruteForce.size(), 0);
+}
+
+/**
+ * A test fixture with random points whose count is not a multiple of the
+ * block size, used to compare the brute force engine to a naive search.
+ */
+class BruteForceFixture : public ::testing::Test {
+  protected:
+    vector<Point> vec;
+    vector<Point> queries;
+    vector<vector<pair<double, double>>> regions;
+
+  public:
+    BruteForceFixture() {
+        mt19937 rng(5);
+        vec = clusteredPoints(1003, 5, rng);
+        queries = uniformPoints(40, 5, rng);
+        for (Point& query : queries) {
+            vector<pair<double, double>> region;
+            for (double f : query.features) {
+                region.push_back(make_pair(f - 30, f + 30));
+            }
+            regions.push_back(region);
+        }
+    }
+
+    /** Asserts that the engine agrees with a naive search */
+    template <class Engine, class Metric>
+    void check(Engine& engine, const Metric& metric) {
+        BasicNaiveSearch<Metric> naiveSearch(metric);
+        engine.build(vec);
+        naiveSearch.build(vec);
+        for (Point& query : queries) {
+            Point* expected = naiveSearch.findNearestNeighbor(query);
+            Point* actual = engine.findNearestNeighbor(query);
+            expected->setDistToQuery(query, metric);
+            actual->setDistToQuery(query, metric);
+            ASSERT_DOUBLE_EQ(actual->distToQuery, expected->distToQuery);
+        }
+        for (vector<pair<double, double>>& region : regions) {
+            vector<Point> expected = naiveSearch.rangeSearch(region);
+            vector<Point> actual = engine.rangeSearch(region);
+            sort(expected.begin(), expected.end(), lessFeatures);
+            sort(actual.begin(), actual.end(), lessFeatures);
+            ASSERT_EQ(actual, expected);
+        }
+    }
+};
+
+TEST_F(BruteForceFixture, TEST_METRICS) {
+    BasicBruteForce<SquaredEuclidean> euclidean;
+    check(euclidean, SquaredEuclidean());
+    BasicBruteForce<Manhattan> manhattan;
+    check(manhattan, Manhattan());
+    BasicBruteForce<Chebyshev> chebyshev;
+    check(chebyshev, Chebyshev());
+    WeightedSquaredEuclidean weighted({1, 2, 3, 0.5, 0});
+    BasicBruteForce<WeightedSquaredEuclidean> weightedEngine(weighted);
+    check(weightedEngine, weighted);
+}
+
+TEST_F(BruteForceFixture, TEST_MULTI_THREADED) {
+    // enough points that every scan is split over threads
+    mt19937 rng(6);
+    vec = uniformPoints(300000, 4, rng);
+    for (vector<pair<double, double>>& region : regions) region.resize(4);
+    for (Point& query : queries) query.features.resize(4), query.numDim = 4;
+    BruteForce bruteForce(SquaredEuclidean(), 4);
+    check(bruteForce, SquaredEuclidean());
+}
+
+TEST_F(BruteForceFixture, TEST_AUTO_INDEX_SMALL) {
+    AutoIndex index;
+    check(index, SquaredEuclidean());
+    // Assert small data sets are scanned by brute force
+    ASSERT_FALSE(index.usesKDT());
+    ASSERT_EQ(index.size(), vec.size());
+}
+
+TEST_F(BruteForceFixture, TEST_AUTO_INDEX_LARGE) {
+    mt19937 rng(7);
+    vec = uniformPoints(100000, 2, rng);
+    for (vector<pair<double, double>>& region : regions) region.resize(2);
+    for (Point& query : queries) query.features.resize(2), query.numDim = 2;
+    AutoIndex index;
+    check(index, SquaredEuclidean());
+    // Assert a large low dimensional data set is searched with a KD tree
+    ASSERT_TRUE(index.usesKDT());
+}
@@ -0,0 +1,227 @@
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+#include "DiskKDT.hpp"
+#include "Distributions.hpp"
+#include "NaiveSearch.hpp"
+#include "Point.hpp"
+
+using namespace std;
+using namespace testing;
+
+// index file written by the tests in the working directory
+const string INDEX_PATH = "test_DiskKDT.index";
+
+/** Orders points by their features so results can be compared as sets */
+bool lessFeatures(const Point& p1, const Point& p2) {
+    return p1.features < p2.features;
+}
+
+/** Asserts that the disk tree answers queries like a naive search */
+void checkAgainstNaive(DiskKDT& tree, vector<Point>& data,
+                       vector<Point>& queries) {
+    NaiveSearch naive;
+    naive.build(data);
+    for (Point& query : queries) {
+        Point* expected = naive.findNearestNeighbor(query);
+        Point* actual = tree.findNearestNeighbor(query);
+        ASSERT_NE(actual, nullptr);
+        ASSERT_DOUBLE_EQ(actual->distToQuery, expected->distToQuery);
+    }
+    vector<pair<double, double>> region(data[0].numDim, make_pair(20, 45));
+    vector<Point> expected = naive.rangeSearch(region);
+    vector<Point> actual = tree.rangeSearch(region);
+    sort(expected.begin(), expected.end(), lessFeatures);
+    sort(actual.begin(), actual.end(), lessFeatures);
+    ASSERT_EQ(actual.size(), expected.size());
+    for (unsigned int i = 0; i < actual.size(); i++) {
+        ASSERT_EQ(actual[i].features, expected[i].features);
+    }
+}
+
+TEST(DiskKDTTests, TEST_EMPTY) {
+    DiskKDT tree;
+    vector<Point> vec;
+    ASSERT_TRUE(tree.build(vec, INDEX_PATH));
+    Point queryPoint({5.81, 3.21});
+    vector<pair<double, double>> region = {{0, 10}, {0, 10}};
+    // Assert searching an empty index finds nothing
+    ASSERT_EQ(tree.findNearestNeighbor(queryPoint), nullptr);
+    ASSERT_EQ(tree.rangeSearch(region).size(), 0);
+    ASSERT_EQ(tree.size(), 0);
+    ASSERT_EQ(tree.height(), -1);
+    remove(INDEX_PATH.c_str());
+}
+
+TEST(DiskKDTTests, TEST_REOPEN_EMPTY) {
+    {
+        DiskKDT tree;
+        vector<Point> vec;
+        ASSERT_TRUE(tree.build(vec, INDEX_PATH));
+    }
+    // Assert an index of no points can be saved and opened again
+    DiskKDT tree;
+    ASSERT_TRUE(tree.open(INDEX_PATH));
+    Point queryPoint({5.81});
+    vector<pair<double, double>> region = {{0, 10}};
+    ASSERT_EQ(tree.findNearestNeighbor(queryPoint), nullptr);
+    ASSERT_EQ(tree.rangeSearch(region).size(), 0);
+    ASSERT_EQ(tree.size(), 0);
+    ASSERT_EQ(tree.height(), -1);
+    tree.close();
+    remove(INDEX_PATH.c_str());
+}
+
+TEST(DiskKDTTests, TEST_IN_MEMORY_BUILD) {
+    mt19937 rng(7);
+    vector<Point> data = uniformPoints(5000, 3, rng);
+    vector<Point> queries = uniformPoints(200, 3, rng);
+    DiskKDT tree;
+    tree.setPageSize(512);
+    ASSERT_TRUE(tree.build(data, INDEX_PATH));
+    // Assert every point is stored in pages of at most 21 points
+    ASSERT_EQ(tree.size(), 5000);
+    ASSERT_GE(tree.pages(), 5000 / 21);
+    checkAgainstNaive(tree, data, queries);
+    remove(INDEX_PATH.c_str());
+}
+
+TEST(DiskKDTTests, TEST_OUT_OF_CORE_BUILD) {
+    mt19937 rng(11);
+    vector<Point> data = clusteredPoints(20000, 4, rng);
+    vector<Point> queries = uniformPoints(200, 4, rng);
+    DiskKDT tree;
+    tree.setPageSize(1024);
+    // Assert a budget of 500 points still builds a balanced tree
+    tree.setMemoryBudget(500 * 4 * sizeof(double));
+    ASSERT_TRUE(tree.build(data, INDEX_PATH));
+    ASSERT_EQ(tree.size(), 20000);
+    ASSERT_LE(tree.height(), 12);
+    checkAgainstNaive(tree, data, queries);
+    remove(INDEX_PATH.c_str());
+}
+
+TEST(DiskKDTTests, TEST_DUPLICATES_OUT_OF_CORE) {
+    mt19937 rng(3);
+    vector<Point> data = duplicatePoints(10000, 2, rng);
+    for (int i = 0; i < 3000; i++) {
+        data.push_back(Point({50.0, 50.0}));
+    }
+    vector<Point> queries = uniformPoints(100, 2, rng);
+    DiskKDT tree;
+    tree.setPageSize(256);
+    tree.setMemoryBudget(100 * 2 * sizeof(double));
+    // Assert many equal points are still split into pages
+    ASSERT_TRUE(tree.build(data, INDEX_PATH));
+    ASSERT_EQ(tree.size(), 13000);
+    checkAgainstNaive(tree, data, queries);
+    remove(INDEX_PATH.c_str());
+}
+
+TEST(DiskKDTTests, TEST_BOUNDED_CACHE) {
+    mt19937 rng(5);
+    vector<Point> data = uniformPoints(20000, 2, rng);
+    vector<Point> queries = uniformPoints(500, 2, rng);
+    DiskKDT tree;
+    tree.setPageSize(256);
+    tree.setCacheSize(8);
+    ASSERT_TRUE(tree.build(data, INDEX_PATH));
+    checkAgainstNaive(tree, data, queries);
+    // Assert no more pages are cached than allowed, and repeated queries
+    // are served from the cache
+    ASSERT_LE(tree.cachedPages(), 8);
+    unsigned long long reads = tree.pageReads();
+    ASSERT_GT(reads, 8);
+    tree.findNearestNeighbor(queries[0]);
+    tree.findNearestNeighbor(queries[0]);
+    ASSERT_GT(tree.cacheHits(), 0);
+    remove(INDEX_PATH.c_str());
+}
+
+TEST(DiskKDTTests, TEST_REOPEN) {
+    mt19937 rng(9);
+    vector<Point> data = uniformPoints(3000, 3, rng);
+    vector<Point> queries = uniformPoints(100, 3, rng);
+    int height;
+    {
+        DiskKDT tree;
+        tree.setPageSize(512);
+        ASSERT_TRUE(tree.build(data, INDEX_PATH));
+        height = tree.height();
+    }
+    // Assert an index opened from its file answers the same queries
+    DiskKDT tree;
+    ASSERT_TRUE(tree.open(INDEX_PATH));
+    ASSERT_EQ(tree.size(), 3000);
+    ASSERT_EQ(tree.height(), height);
+    checkAgainstNaive(tree, data, queries);
+    tree.close();
+    remove(INDEX_PATH.c_str());
+    ASSERT_FALSE(tree.open(INDEX_PATH));
+}
+
+/** Reads a whole file into memory */
+vector<char> readFile(const string& path) {
+    ifstream in(path, ios::binary);
+    return vector<char>(istreambuf_iterator<char>(in),
+                        istreambuf_iterator<char>());
+}
+
+/** Writes bytes to a file, replacing it */
+void writeFile(const string& path, const vector<char>& bytes) {
+    ofstream out(path, ios::binary | ios::trunc);
+    out.write(bytes.data(), bytes.size());
+}
+
+/** Returns a copy of bytes with the unsigned int at offset set to value */
+vector<char> patched(vector<char> bytes, size_t offset, unsigned int value) {
+    memcpy(&bytes[offset], &value, sizeof(value));
+    return bytes;
+}
+
+TEST(DiskKDTTests, TEST_CORRUPT_INDEX) {
+    mt19937 rng(13);
+    vector<Point> data = uniformPoints(2000, 2, rng);
+    vector<Point> queries = uniformPoints(20, 2, rng);
+    {
+        DiskKDT tree;
+        tree.setPageSize(256);
+        ASSERT_TRUE(tree.build(data, INDEX_PATH));
+    }
+    vector<char> good = readFile(INDEX_PATH);
+    // header fields after the 8 byte magic: numDim, pageBytes, numPages,
+    // numNodes and root, 4 bytes each
+    vector<vector<char>> corrupt = {
+        vector<char>(good.begin(), good.end() - 1),  // truncated
+        patched(good, 12, 4),                        // page too small
+        patched(good, 16, 0xFFFFFFF0u),              // pages past the end
+        patched(good, 24, 0xFFFFFFF0u),              // root past the nodes
+    };
+    // Assert an index that does not fit its file is rejected on open
+    for (const vector<char>& bytes : corrupt) {
+        writeFile(INDEX_PATH, bytes);
+        DiskKDT tree;
+        ASSERT_FALSE(tree.open(INDEX_PATH));
+        ASSERT_EQ(tree.findNearestNeighbor(queries[0]), nullptr);
+    }
+
+    // Assert a page claiming too many points is read as empty
+    vector<char> badPage = patched(good, 256, 0xFFFFFFF0u);
+    writeFile(INDEX_PATH, badPage);
+    DiskKDT tree;
+    ASSERT_TRUE(tree.open(INDEX_PATH));
+    vector<pair<double, double>> everything(2, make_pair(-1e9, 1e9));
+    ASSERT_LT(tree.rangeSearch(everything).size(), data.size());
+    for (Point& query : queries) {
+        tree.findNearestNeighbor(query);
+    }
+    tree.close();
+    remove(INDEX_PATH.c_str());
+}
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "Distributions.hpp"
+#include "GridIndex.hpp"
+#include "KDT.hpp"
+#include "NaiveSearch.hpp"
+#include "Point.hpp"
+#include "util.hpp"
+
+using namespace std;
+using namespace testing;
+
+/** Orders points by their features so results can be compared as sets */
+bool lessFeatures(const Point& p1, const Point& p2) {
+    return p1.features < p2.features;
+}
+
+TEST(GridIndexTests, TEST_EMPTY) {
+    GridIndex grid;
+    vector<Point> vec;
+    grid.build(vec);
+    Point queryPoint({5.81, 3.21});
+    vector<pair<double, double>> region = {{0, 10}, {0, 10}};
+    // Assert searching an empty grid finds nothing
+    ASSERT_EQ(grid.findNearestNeighbor(queryPoint), nullptr);
+    ASSERT_EQ(grid.rangeSearch(region).size(), 0);
+    ASSERT_EQ(grid.size(), 0);
+}
+
+TEST(GridIndexTests, TEST_FLAT_DIMENSION) {
+    GridIndex grid;
+    vector<Point> vec;
+    for (int i = 0; i < 50; i++) {
+        vec.push_back(Point({(double)i, 7.0}));
+    }
+    grid.build(vec);
+    // Assert the flat second dimension gets a single cell
+    ASSERT_EQ(grid.numCells(), 25);
+    Point queryPoint({20.2, -3.0});
+    ASSERT_EQ(*grid.findNearestNeighbor(queryPoint), Point({20.0, 7.0}));
+}
+
+TEST(GridIndexTests, TEST_INVERTED_REGION) {
+    GridIndex grid;
+    KDT kdt;
+    vector<Point> vec;
+    for (int i = 0; i < 100; i++) {
+        vec.push_back(Point({(double)(i % 10), (double)(i / 10)}));
+    }
+    grid.build(vec);
+    kdt.build(vec);
+    // Assert a region whose lower end is above its upper end, inside the
+    // bounding box, is empty like in KDT
+    vector<pair<double, double>> region = {{6, 2}, {1, 8}};
+    ASSERT_EQ(grid.rangeSearch(region).size(), 0);
+    ASSERT_EQ(kdt.rangeSearch(region).size(), 0);
+}
+
+TEST(GridIndexTests, TEST_BOUNDING_BOX) {
+    KDT kdt;
+    vector<Point> vec = {Point({-3.0, -1.5}), Point({-2.0, -4.0}),
+                         Point({-7.0, -2.5})};
+    kdt.build(vec);
+    // Assert the bounding box is right for all negative coordinates
+    vector<pair<double, double>> expected = {{-7.0, -2.0}, {-4.0, -1.5}};
+    ASSERT_EQ(kdt.getBoundingBox(), expected);
+    ASSERT_EQ(boundingBoxOf(vec), expected);
+}
+
+/**
+ * A test fixture with uniform and clustered points, used to compare the
+ * grid index to a naive search under each metric.
+ */
+class GridIndexFixture : public ::testing::Test {
+  protected:
+    vector<Point> vec;
+    vector<Point> queries;
+    vector<vector<pair<double, double>>> regions;
+
+  public:
+    GridIndexFixture() {
+        mt19937 rng(5);
+        vec = uniformPoints(3000, 2, rng);
+        vector<Point> more = clusteredPoints(1000, 2, rng);
+        vec.insert(vec.end(), more.begin(), more.end());
+        queries = uniformPoints(100, 2, rng);
+        // queries outside the bounding box
+        queries.push_back(Point({-500.0, 50.0}));
+        queries.push_back(Point({1000.0, 1000.0}));
+        for (Point& query : queries) {
+            regions.push_back({make_pair(query.features[0] - 5,
+                                         query.features[0] + 5),
+                               make_pair(query.features[1] - 10,
+                                         query.features[1] + 10)});
+        }
+    }
+
+    /** Asserts that the grid index agrees with a naive search */
+    template <class Metric>
+    void check(const Metric& metric) {
+        BasicGridIndex<Metric> grid(metric);
+        BasicNaiveSearch<Metric> naiveSearch(metric);
+        grid.build(vec);
+        naiveSearch.build(vec);
+        ASSERT_EQ(grid.size(), vec.size());
+        for (Point& query : queries) {
+            Point* expected = naiveSearch.findNearestNeighbor(query);
+            Point* actual = grid.findNearestNeighbor(query);
+            expected->setDistToQuery(query, metric);
+            actual->setDistToQuery(query, metric);
+            ASSERT_DOUBLE_EQ(actual->distToQuery, expected->distToQuery);
+        }
+        for (vector<pair<double, double>>& region : regions) {
+            vector<Point> expected = naiveSearch.rangeSearch(region);
+            vector<Point> actual = grid.rangeSearch(region);
+            sort(expected.begin(), expected.end(), lessFeatures);
+            sort(actual.begin(), actual.end(), lessFeatures);
+            ASSERT_EQ(actual, expected);
+        }
+    }
+};
+
+TEST_F(GridIndexFixture, TEST_EUCLIDEAN) { check(SquaredEuclidean()); }
+
+TEST_F(GridIndexFixture, TEST_MANHATTAN) { check(Manhattan()); }
+
+TEST_F(GridIndexFixture, TEST_CHEBYSHEV) { check(Chebyshev()); }
+
+TEST_F(GridIndexFixture, TEST_THREE_DIMENSIONS) {
+    mt19937 rng(9);
+    vec = uniformPoints(2000, 3, rng);
+    queries = uniformPoints(50, 3, rng);
+    regions.clear();
+    for (Point& query : queries) {
+        vector<pair<double, double>> region;
+        for (double f : query.features) {
+            region.push_back(make_pair(f - 8, f + 8));
+        }
+        regions.push_back(region);
+    }
+    check(SquaredEuclidean());
+}
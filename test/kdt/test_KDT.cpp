@@ -1,10 +1,13 @@
 #include <gtest/gtest.h>
 #include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <iostream>
+#include <random>
 #include <set>
 #include <string>
 #include <vector>
+#include "Distributions.hpp"
 #include "KDT.hpp"
 #include "NaiveSearch.hpp"
 #include "Point.hpp"
@@ -161,3 +164,435 @@ TEST_F(LargeKDTFixture, TEST_RANGE_SEARCH) {
     kdt.rangeSearch(queryRegion);
     ASSERT_EQ(kdt.rangeSearch(queryRegion), answer);
 }
+
+/**
+ * A test fixture with random points, used to check that every distance
+ * metric finds the same nearest neighbor as a naive search.
+ */
+class MetricKDTFixture : public ::testing::Test {
+  protected:
+    vector<Point> vec;
+    vector<Point> queries;
+
+  public:
+    MetricKDTFixture() {
+        srand(100);
+        for (int i = 0; i < 500; i++) {
+            vec.emplace_back(Point({(double)(rand() % 1000) / 10,
+                                    (double)(rand() % 1000) / 10,
+                                    (double)(rand() % 1000) / 10}));
+        }
+        for (int i = 0; i < 50; i++) {
+            queries.emplace_back(Point({(double)(rand() % 1000) / 10,
+                                        (double)(rand() % 1000) / 10,
+                                        (double)(rand() % 1000) / 10}));
+        }
+    }
+
+    /** Asserts that the KDT and naive search agree on every query distance */
+    template <class Metric>
+    void checkMetric(const Metric& metric) {
+        BasicKDT<Metric> kdt(metric);
+        BasicNaiveSearch<Metric> naiveSearch(metric);
+        kdt.build(vec);
+        naiveSearch.build(vec);
+        for (Point& query : queries) {
+            Point* expected = naiveSearch.findNearestNeighbor(query);
+            Point* actual = kdt.findNearestNeighbor(query);
+            expected->setDistToQuery(query, metric);
+            actual->setDistToQuery(query, metric);
+            ASSERT_DOUBLE_EQ(actual->distToQuery, expected->distToQuery);
+        }
+    }
+};
+
+TEST_F(MetricKDTFixture, TEST_SQUARED_EUCLIDEAN) {
+    checkMetric(SquaredEuclidean());
+}
+
+TEST_F(MetricKDTFixture, TEST_MANHATTAN) { checkMetric(Manhattan()); }
+
+TEST_F(MetricKDTFixture, TEST_CHEBYSHEV) { checkMetric(Chebyshev()); }
+
+TEST_F(MetricKDTFixture, TEST_WEIGHTED) {
+    checkMetric(WeightedSquaredEuclidean({4, 1, 0.25}));
+}
+
+/**
+ * A test fixture with points stretched along the first dimension, used to
+ * check every split rule against a naive search.
+ */
+class SplitRuleKDTFixture : public ::testing::Test {
+  protected:
+    vector<Point> vec;
+    vector<Point> queries;
+    vector<vector<pair<double, double>>> regions;
+
+  public:
+    SplitRuleKDTFixture() {
+        srand(7);
+        for (int i = 0; i < 1000; i++) {
+            vec.emplace_back(Point({(double)(rand() % 10000) / 10,
+                                    (double)(rand() % 100) / 100,
+                                    (double)(rand() % 100) / 10}));
+        }
+        for (int i = 0; i < 50; i++) {
+            queries.emplace_back(Point({(double)(rand() % 10000) / 10,
+                                        (double)(rand() % 100) / 100,
+                                        (double)(rand() % 100) / 10}));
+            double low = (double)(rand() % 900);
+            regions.push_back({make_pair(low, low + 100), make_pair(0.2, 0.7),
+                               make_pair(2.0, 6.0)});
+        }
+    }
+
+    /** Asserts that a KDT built with rule agrees with a naive search */
+    void checkRule(SplitRule rule) {
+        KDT kdt;
+        NaiveSearch naiveSearch;
+        kdt.setSplitRule(rule);
+        kdt.build(vec);
+        naiveSearch.build(vec);
+        ASSERT_EQ(kdt.size(), vec.size());
+
+        for (Point& query : queries) {
+            Point* expected = naiveSearch.findNearestNeighbor(query);
+            Point* actual = kdt.findNearestNeighbor(query);
+            expected->setDistToQuery(query);
+            actual->setDistToQuery(query);
+            ASSERT_DOUBLE_EQ(actual->distToQuery, expected->distToQuery);
+        }
+        for (vector<pair<double, double>>& region : regions) {
+            ASSERT_EQ(kdt.rangeSearch(region).size(),
+                      naiveSearch.rangeSearch(region).size());
+        }
+    }
+};
+
+TEST_F(SplitRuleKDTFixture, TEST_CYCLE) { checkRule(CYCLE); }
+
+TEST_F(SplitRuleKDTFixture, TEST_MAX_SPREAD) { checkRule(MAX_SPREAD); }
+
+TEST_F(SplitRuleKDTFixture, TEST_SLIDING_MIDPOINT) {
+    checkRule(SLIDING_MIDPOINT);
+}
+
+TEST_F(SplitRuleKDTFixture, TEST_SURFACE_AREA) { checkRule(SURFACE_AREA); }
+
+TEST(KdtTests, TEST_SLIDING_MIDPOINT_DUPLICATES) {
+    KDT kdt;
+    vector<Point> vec(100, Point({2.0, 2.0}));
+    kdt.setSplitRule(SLIDING_MIDPOINT);
+    kdt.build(vec);
+    // Assert identical points still build a balanced tree
+    ASSERT_EQ(kdt.height(), 6);
+}
+
+TEST(KdtTests, TEST_SLIDING_MIDPOINT_SKEWED) {
+    KDT kdt;
+    vector<Point> vec;
+    for (int i = 0; i < 1000; i++) {
+        vec.push_back(Point({ldexp(1.0, -i), 0.0}));
+    }
+    kdt.setSplitRule(SLIDING_MIDPOINT);
+    kdt.build(vec);
+    // Assert values halving at every step do not build a list-like tree
+    ASSERT_LE(kdt.height(), 30);
+    Point query({0.3, 0.0});
+    ASSERT_EQ(kdt.findNearestNeighbor(query)->features[0], 0.25);
+}
+
+TEST_F(SplitRuleKDTFixture, TEST_PARALLEL_RANGE_SEARCH) {
+    KDT kdt;
+    kdt.build(vec);
+    // Assert parallel range search returns the same points in the same order
+    for (vector<pair<double, double>>& region : regions) {
+        ASSERT_EQ(kdt.parallelRangeSearch(region, 4), kdt.rangeSearch(region));
+    }
+    vector<pair<double, double>> everything{
+        make_pair(0, 1000), make_pair(0, 1), make_pair(0, 10)};
+    ASSERT_EQ(kdt.parallelRangeSearch(everything, 3).size(), vec.size());
+    ASSERT_EQ(kdt.parallelRangeSearch(everything, 1),
+              kdt.rangeSearch(everything));
+}
+
+/** Orders points by their features so results can be compared as sets */
+bool lessFeatures(const Point& p1, const Point& p2) {
+    return p1.features < p2.features;
+}
+
+/** Asserts that a lazily built KDT gives the same results as a full build */
+void checkLazy(vector<Point>& vec, vector<Point>& queries,
+               vector<vector<pair<double, double>>>& regions, SplitRule rule) {
+    KDT kdt;
+    KDT lazyKdt;
+    kdt.setSplitRule(rule);
+    lazyKdt.setSplitRule(rule);
+    lazyKdt.setLazyBuild(true);
+    vector<Point> points = vec;
+    kdt.build(points);
+    points = vec;
+    lazyKdt.build(points);
+    ASSERT_EQ(lazyKdt.size(), kdt.size());
+
+    for (Point& query : queries) {
+        Point* expected = kdt.findNearestNeighbor(query);
+        Point* actual = lazyKdt.findNearestNeighbor(query);
+        ASSERT_DOUBLE_EQ(actual->distToQuery, expected->distToQuery);
+    }
+    for (vector<pair<double, double>>& region : regions) {
+        vector<Point> expected = kdt.rangeSearch(region);
+        vector<Point> actual = lazyKdt.rangeSearch(region);
+        sort(expected.begin(), expected.end(), lessFeatures);
+        sort(actual.begin(), actual.end(), lessFeatures);
+        ASSERT_EQ(actual, expected);
+        ASSERT_EQ(lazyKdt.parallelRangeSearch(region, 4),
+                  lazyKdt.rangeSearch(region));
+    }
+    vector<pair<double, double>> everything{
+        make_pair(0, 1000), make_pair(0, 1), make_pair(0, 10)};
+    ASSERT_EQ(lazyKdt.rangeSearch(everything).size(), vec.size());
+    // every subtree has been built now
+    ASSERT_EQ(lazyKdt.height(), kdt.height());
+}
+
+TEST_F(SplitRuleKDTFixture, TEST_LAZY_BUILD) {
+    for (SplitRule rule : {CYCLE, MAX_SPREAD, SLIDING_MIDPOINT, SURFACE_AREA}) {
+        checkLazy(vec, queries, regions, rule);
+    }
+}
+
+TEST_F(SplitRuleKDTFixture, TEST_LAZY_BUILD_HEIGHT) {
+    KDT kdt;
+    kdt.setLazyBuild(true);
+    kdt.build(vec);
+    // Assert a lazy median split tree knows its size and height up front
+    ASSERT_EQ(kdt.size(), 1000);
+    ASSERT_EQ(kdt.height(), 9);
+}
+
+TEST_F(SplitRuleKDTFixture, TEST_LAZY_BUILD_SETTINGS_CHANGED) {
+    KDT kdt;
+    kdt.build(vec);
+    KDT lazyKdt;
+    lazyKdt.setLazyBuild(true);
+    vector<Point> points = vec;
+    lazyKdt.build(points);
+    // Assert settings changed after a lazy build only apply to the next
+    // build, not to the subtrees still waiting to be built
+    lazyKdt.setLazyBuild(false);
+    lazyKdt.setSplitRule(SURFACE_AREA);
+    lazyKdt.setCellBounds(false);
+    for (Point& query : queries) {
+        ASSERT_DOUBLE_EQ(lazyKdt.findNearestNeighbor(query)->distToQuery,
+                         kdt.findNearestNeighbor(query)->distToQuery);
+    }
+    for (vector<pair<double, double>>& region : regions) {
+        vector<Point> expected = kdt.rangeSearch(region);
+        vector<Point> actual = lazyKdt.parallelRangeSearch(region, 8);
+        sort(expected.begin(), expected.end(), lessFeatures);
+        sort(actual.begin(), actual.end(), lessFeatures);
+        ASSERT_EQ(actual, expected);
+    }
+    vector<pair<double, double>> everything{
+        make_pair(0, 1000), make_pair(0, 1), make_pair(0, 10)};
+    ASSERT_EQ(lazyKdt.rangeSearch(everything).size(), vec.size());
+    ASSERT_EQ(lazyKdt.height(), 9);
+}
+
+TEST_F(SplitRuleKDTFixture, TEST_BATCH_NEAREST_NEIGHBORS) {
+    KDT kdt;
+    kdt.build(vec);
+    vector<Point> expected;
+    for (Point& query : queries) {
+        expected.push_back(*kdt.findNearestNeighbor(query));
+    }
+    // Assert every group size finds the same neighbors as single searches
+    for (unsigned int groupSize : {1, 3, 16, 100}) {
+        vector<Point> actual = kdt.findNearestNeighbors(queries, groupSize);
+        ASSERT_EQ(actual.size(), queries.size());
+        for (unsigned int i = 0; i < queries.size(); i++) {
+            ASSERT_EQ(actual[i], expected[i]);
+            ASSERT_DOUBLE_EQ(actual[i].distToQuery, expected[i].distToQuery);
+        }
+    }
+
+    // Assert batches also work while a lazy tree is being built
+    KDT lazyKdt;
+    lazyKdt.setLazyBuild(true);
+    lazyKdt.build(vec);
+    vector<Point> actual = lazyKdt.findNearestNeighbors(queries);
+    for (unsigned int i = 0; i < queries.size(); i++) {
+        ASSERT_DOUBLE_EQ(actual[i].distToQuery, expected[i].distToQuery);
+    }
+}
+
+TEST_F(SplitRuleKDTFixture, TEST_BUDGETED_SEARCH) {
+    KDT kdt;
+    kdt.build(vec);
+    for (Point& query : queries) {
+        double expected = kdt.findNearestNeighbor(query)->distToQuery;
+        bool exact = false;
+
+        // Assert an unlimited budget gives the exact answer
+        Point* actual = kdt.findNearestNeighbor(query, SearchBudget(), exact);
+        ASSERT_TRUE(exact);
+        ASSERT_DOUBLE_EQ(actual->distToQuery, expected);
+
+        // Assert a tiny budget still gives a candidate, but not a proven one
+        SearchBudget budget;
+        budget.maxNodes = 2;
+        actual = kdt.findNearestNeighbor(query, budget, exact);
+        ASSERT_FALSE(exact);
+        ASSERT_NE(actual, nullptr);
+        ASSERT_GE(actual->distToQuery, expected);
+        Point copy = *actual;
+        copy.setDistToQuery(query);
+        ASSERT_DOUBLE_EQ(copy.distToQuery, actual->distToQuery);
+
+        // Assert a deadline that has passed stops the search
+        budget = SearchBudget();
+        budget.deadline = chrono::steady_clock::now();
+        actual = kdt.findNearestNeighbor(query, budget, exact);
+        ASSERT_FALSE(exact);
+        ASSERT_GE(actual->distToQuery, expected);
+    }
+
+    // Assert an empty tree is trivially exact
+    KDT empty;
+    bool exact = false;
+    ASSERT_EQ(empty.findNearestNeighbor(queries[0], SearchBudget(), exact),
+              nullptr);
+    ASSERT_TRUE(exact);
+}
+
+TEST(KdtTests, TEST_CELL_BOUNDS) {
+    mt19937 rng(3);
+    vector<Point> vec = clusteredPoints(5000, 3, rng);
+    vector<Point> queries = uniformPoints(50, 3, rng);
+    KDT kdt;
+    KDT planeKdt;
+    planeKdt.setCellBounds(false);
+    vector<Point> points = vec;
+    kdt.build(points);
+    points = vec;
+    planeKdt.build(points);
+
+    // Assert pruning by node bounding boxes finds the same neighbors and
+    // range results, in the same order, while visiting fewer nodes
+    unsigned long long visits = 0;
+    unsigned long long planeVisits = 0;
+    for (Point& query : queries) {
+        ASSERT_EQ(*kdt.findNearestNeighbor(query),
+                  *planeKdt.findNearestNeighbor(query));
+        visits += kdt.lastSearchStats().nodesVisited;
+        planeVisits += planeKdt.lastSearchStats().nodesVisited;
+
+        vector<pair<double, double>> region;
+        for (double f : query.features) {
+            region.push_back(make_pair(f - 20, f + 20));
+        }
+        ASSERT_EQ(kdt.rangeSearch(region), planeKdt.rangeSearch(region));
+        ASSERT_EQ(kdt.parallelRangeSearch(region, 4),
+                  planeKdt.rangeSearch(region));
+    }
+    if (SearchStats::enabled) {
+        ASSERT_LT(visits, planeVisits);
+    }
+}
+
+TEST(KdtTests, TEST_COLLAPSE_DUPLICATES) {
+    mt19937 rng(4);
+    vector<Point> vec = duplicatePoints(2000, 2, rng);
+    // nearly equal to point 0, within the tolerance of Point::operator==
+    vec.push_back(Point({vec[0].features[0], vec[0].features[1] + 0.00001}));
+    vector<Point> queries = uniformPoints(30, 2, rng);
+
+    KDT kdt;
+    KDT fullKdt;
+    kdt.setCollapseDuplicates(true);
+    vector<Point> points = vec;
+    kdt.build(points);
+    points = vec;
+    fullKdt.build(points);
+    // Assert one node is stored per distinct location
+    ASSERT_LT(kdt.size(), 200);
+    ASSERT_LT(kdt.height(), fullKdt.height());
+
+    NaiveSearch naiveSearch;
+    naiveSearch.build(vec);
+    for (Point& query : queries) {
+        // Assert the nearest location reports the ids of all its copies
+        // (up to the tolerance by which collapsed points may differ)
+        Point nearest = *kdt.findNearestNeighbor(query);
+        ASSERT_NEAR(nearest.distToQuery,
+                    fullKdt.findNearestNeighbor(query)->distToQuery, 0.01);
+        vector<unsigned int> ids = kdt.findNearestNeighborIds(query);
+        ASSERT_EQ(ids.size(), kdt.multiplicity(nearest));
+        for (unsigned int id : ids) {
+            ASSERT_EQ(vec[id], nearest);
+        }
+
+        // Assert range search reports the id of every point in the region
+        vector<pair<double, double>> region{
+            make_pair(query.features[0] - 10, query.features[0] + 10),
+            make_pair(query.features[1] - 10, query.features[1] + 10)};
+        vector<unsigned int> rangeIds = kdt.rangeSearchIds(region);
+        sort(rangeIds.begin(), rangeIds.end());
+        vector<unsigned int> expected;
+        for (unsigned int i = 0; i < vec.size(); i++) {
+            if (vec[i].features[0] >= region[0].first &&
+                vec[i].features[0] <= region[0].second &&
+                vec[i].features[1] >= region[1].first &&
+                vec[i].features[1] <= region[1].second) {
+                expected.push_back(i);
+            }
+        }
+        ASSERT_EQ(rangeIds, expected);
+    }
+
+    // Assert the nearly equal point shares the node of point 0
+    ASSERT_EQ(kdt.findNearestNeighborIds(vec.back()).back(), vec.size() - 1);
+
+    // Assert trees without collapsed duplicates have no ids
+    ASSERT_TRUE(fullKdt.findNearestNeighborIds(queries[0]).empty());
+    ASSERT_EQ(fullKdt.multiplicity(vec[0]), 1);
+}
+
+TEST(KdtTests, TEST_BATCH_EMPTY) {
+    KDT kdt;
+    vector<Point> queries{Point({1.0, 2.0})};
+    // Assert a batch against an empty tree finds nothing
+    ASSERT_TRUE(kdt.findNearestNeighbors(queries).empty());
+}
+
+TEST_F(SmallKDTFixture, TEST_REBUILD) {
+    // Assert building again replaces the previous tree
+    kdt.build(vec);
+    ASSERT_EQ(kdt.size(), 5);
+    ASSERT_EQ(kdt.height(), 2);
+}
+
+TEST_F(LargeKDTFixture, TEST_SEARCH_STATS) {
+    Point queryPoint({4, 8});
+    kdt.findNearestNeighbor(queryPoint);
+    const SearchStats& stats = kdt.lastSearchStats();
+    if (!SearchStats::enabled) {
+        // Assert nothing is counted unless built with KDT_STATS
+        ASSERT_EQ(stats.nodesVisited, 0);
+        return;
+    }
+    // Assert every visited node computed one distance, and that visits plus
+    // pruned subtrees stay within the tree
+    ASSERT_EQ(stats.distanceEvals, stats.nodesVisited);
+    ASSERT_GT(stats.nodesVisited, 0);
+    ASSERT_LE(stats.nodesVisited, 10);
+    ASSERT_LE(stats.maxDepth, 4);
+    ASSERT_GT(stats.leavesScanned, 0);
+
+    vector<pair<double, double>> queryRegion{make_pair(3, 6),
+                                             make_pair(3, 6)};
+    kdt.rangeSearch(queryRegion);
+    ASSERT_GT(kdt.lastSearchStats().nodesVisited, 0);
+    ASSERT_EQ(kdt.lastSearchStats().distanceEvals, 0);
+}
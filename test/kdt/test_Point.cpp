@@ -51,4 +51,19 @@ TEST(PointTests, TEST_OUTPUT_OPERATOR) {
     Point p(pValues);
     // Assert output works correctly
     cerr << "TEST_OUTPUT_OPERATOR: " << p << endl;
-}
\ No newline at end of file
+}
+
+TEST(PointTests, TEST_DISTANCE_METRICS) {
+    Point p1({1, 2, 3, 4, 5});
+    Point p2({2, 0, 3, 8, 4});
+
+    // Assert each metric computes its own distance
+    p1.setDistToQuery(p2, SquaredEuclidean());
+    ASSERT_DOUBLE_EQ(p1.distToQuery, 22.0);
+    p1.setDistToQuery(p2, Manhattan());
+    ASSERT_DOUBLE_EQ(p1.distToQuery, 8.0);
+    p1.setDistToQuery(p2, Chebyshev());
+    ASSERT_DOUBLE_EQ(p1.distToQuery, 4.0);
+    p1.setDistToQuery(p2, WeightedSquaredEuclidean({1, 0.5, 0, 2, 1}));
+    ASSERT_DOUBLE_EQ(p1.distToQuery, 36.0);
+}
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "Distributions.hpp"
+#include "NaiveSearch.hpp"
+#include "Point.hpp"
+#include "VPTree.hpp"
+#include "util.hpp"
+
+using namespace std;
+using namespace testing;
+
+/* Test empty tree */
+TEST(VPTreeTests, TEST_EMPTY) {
+    VPTree vpt;
+    vector<Point> vec;
+    vpt.build(vec);
+    Point queryPoint({5.81, 3.21});
+    // Assert empty tree has no points and no nearest neighbor
+    ASSERT_EQ(vpt.size(), 0);
+    ASSERT_EQ(vpt.height(), -1);
+    ASSERT_EQ(vpt.findNearestNeighbor(queryPoint), nullptr);
+}
+
+TEST(VPTreeTests, TEST_SIZE_HEIGHT) {
+    VPTree vpt;
+    vector<Point> vec;
+    for (int i = 0; i < 10; i++) {
+        vec.emplace_back(Point({(double)i, (double)(i * i % 7)}));
+    }
+    vpt.build(vec);
+    // Assert the median split keeps the tree balanced
+    ASSERT_EQ(vpt.size(), 10);
+    ASSERT_EQ(vpt.height(), 3);
+}
+
+/**
+ * A test fixture with clustered points in several dimensions, used to
+ * compare the VP tree to a naive search under each metric.
+ */
+class VPTreeFixture : public ::testing::Test {
+  protected:
+    vector<Point> vec;
+    vector<Point> queries;
+    vector<vector<pair<double, double>>> regions;
+
+  public:
+    VPTreeFixture() {
+        mt19937 rng(11);
+        vec = clusteredPoints(2000, 6, rng);
+        vector<Point> more = duplicatePoints(500, 6, rng);
+        vec.insert(vec.end(), more.begin(), more.end());
+        queries = uniformPoints(40, 6, rng);
+        for (Point& query : queries) {
+            vector<pair<double, double>> region;
+            for (double f : query.features) {
+                region.push_back(make_pair(f - 40, f + 40));
+            }
+            regions.push_back(region);
+        }
+    }
+
+    /** Asserts that the VP tree agrees with a naive search */
+    template <class Metric>
+    void check(const Metric& metric) {
+        BasicVPTree<Metric> vpt(metric);
+        BasicNaiveSearch<Metric> naiveSearch(metric);
+        vpt.build(vec);
+        naiveSearch.build(vec);
+        ASSERT_EQ(vpt.size(), vec.size());
+        for (Point& query : queries) {
+            Point* expected = naiveSearch.findNearestNeighbor(query);
+            Point* actual = vpt.findNearestNeighbor(query);
+            expected->setDistToQuery(query, metric);
+            actual->setDistToQuery(query, metric);
+            ASSERT_DOUBLE_EQ(actual->distToQuery, expected->distToQuery);
+        }
+        for (vector<pair<double, double>>& region : regions) {
+            ASSERT_EQ(vpt.rangeSearch(region).size(),
+                      naiveSearch.rangeSearch(region).size());
+        }
+    }
+};
+
+TEST_F(VPTreeFixture, TEST_EUCLIDEAN) { check(SquaredEuclidean()); }
+
+TEST_F(VPTreeFixture, TEST_MANHATTAN) { check(Manhattan()); }
+
+TEST_F(VPTreeFixture, TEST_CHEBYSHEV) { check(Chebyshev()); }
+
+TEST_F(VPTreeFixture, TEST_WEIGHTED) {
+    check(WeightedSquaredEuclidean({1, 2, 0.5, 1, 3, 0.25}));
+}
@@ -78,8 +78,8 @@ void loadVectorFromFile(string filename, vector<T>& vec) {
 /**
  * Inserts all data from a vector into a BST.
  */
-template <typename T>
-void insertIntoBST(vector<T>& vec, BST<T>& bst) {
+template <typename T, typename Compare, bool Counted>
+void insertIntoBST(vector<T>& vec, BST<T, Compare, Counted>& bst) {
     auto vit = vec.begin();
     auto ven = vec.end();
 